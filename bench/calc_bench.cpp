@@ -0,0 +1,890 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           calc_bench.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Benchmark suite for the lexer, parser, evaluators and Number
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "Expression.h"
+#include "BatchEvaluator.h"
+#include "ExpressionCache.h"
+#include "JitExpression.h"
+#include "NumberFormat.h"
+#include "RationalAccumulator.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Every benchmark runs its workload a given number of times. The harness
+// grows that count until one run takes a measurable time, then reports the
+// median ns per operation over a few repetitions.
+
+namespace
+{
+    struct Benchmark
+    {
+        std::string name;
+        std::function<void(size_t iterations)> run;
+        size_t opsPerIteration = 1; // e.g. rows for the per-row workloads
+    };
+
+    struct Result
+    {
+        std::string name;
+        double nsPerOp;
+        size_t iterations;
+    };
+
+    struct Options
+    {
+        std::string filter;
+        std::string jsonPath;
+        std::string baselinePath;
+        double threshold = 10; // percent slower than the baseline to report
+        double minTimeMs = 100;
+        int repetitions = 5;
+        bool list = false;
+        bool verify = false;
+    };
+
+    // Keeps the compiler from dropping a result that is never used
+    template <typename T>
+    inline void keep(const T &value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "m"(value) : "memory");
+#else
+        static const void *volatile sink;
+        sink = &value;
+#endif
+    }
+
+    double secondsOf(const Benchmark &benchmark, size_t iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        benchmark.run(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    Result measure(const Benchmark &benchmark, const Options &options)
+    {
+        const double target = options.minTimeMs / 1000 / options.repetitions;
+        size_t iterations = 1;
+        double seconds = secondsOf(benchmark, iterations);
+        while (seconds < target / 10)
+        {
+            iterations *= 10;
+            seconds = secondsOf(benchmark, iterations);
+        }
+        iterations = std::max<size_t>(1, static_cast<size_t>(iterations * (target / seconds)));
+
+        std::vector<double> samples;
+        for (int i = 0; i < options.repetitions; ++i)
+        {
+            samples.push_back(secondsOf(benchmark, iterations) * 1e9 / (iterations * benchmark.opsPerIteration));
+        }
+        std::sort(samples.begin(), samples.end());
+        return {benchmark.name, samples[samples.size() / 2], iterations};
+    }
+
+    std::string repeat(const std::string &piece, size_t count)
+    {
+        std::string out;
+        out.reserve(piece.size() * count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            out += piece;
+        }
+        return out;
+    }
+
+    // 1 + 2 + ... + terms
+    std::string longSum(size_t terms)
+    {
+        std::string out = "1";
+        for (size_t i = 2; i <= terms; ++i)
+        {
+            out += " + " + std::to_string(i);
+        }
+        return out;
+    }
+
+    // 1/1 + 1/2 + ... + 1/terms
+    std::string harmonicSum(size_t terms)
+    {
+        std::string out = "1/1";
+        for (size_t i = 2; i <= terms; ++i)
+        {
+            out += " + 1/" + std::to_string(i);
+        }
+        return out;
+    }
+
+    // Fractions with little in common, so little cancels in sums and products
+    std::vector<Rational> scatteredFractions(size_t count)
+    {
+        std::vector<Rational> out;
+        for (size_t k = 1; k <= count; ++k)
+        {
+            out.push_back(Rational::fraction(static_cast<int64_t>(k * 7919 % 997 + 1),
+                                             static_cast<int64_t>(k * 104729 % 9973 + 2)));
+        }
+        return out;
+    }
+
+    std::string deepNesting(size_t depth)
+    {
+        return repeat("(1 + ", depth) + "1" + repeat(")", depth);
+    }
+
+    std::string hugeLiteral(size_t digits, char first)
+    {
+        std::string out(digits, '7');
+        out[0] = first;
+        return out;
+    }
+
+    // Small expressions shared by the lexer, parser and evaluator groups
+    const std::pair<const char *, const char *> expressions[] = {
+        {"arith", "1 + 2 * 3"},
+        {"parens", "(1 + 2) * (3 + 4) - 5 / 6"},
+        {"fractions", "1 / 3 + 1 / 7 + 1 / 11 + 1 / 13 + 1 / 17"},
+        {"nested", "((2 + 3) * 4 - (5 - 6) * 7) / ((8 + 9) * 10)"},
+        {"logic", "1 < 2 && 3 >= 3 || 4 != 4"},
+        {"unary", "-(1 + -2) * -(3 - -4) + 5 * 6 * 7 * 8 - 9"},
+    };
+
+    void addExpressionBenchmarks(std::vector<Benchmark> &out)
+    {
+        for (const auto &entry : expressions)
+        {
+            auto exp = std::make_shared<Expression>(entry.second);
+            out.push_back({std::string("lex/") + entry.first, [exp](size_t n) {
+                               for (size_t i = 0; i < n; ++i)
+                               {
+                                   exp->lex();
+                                   keep(exp->tokens().size());
+                               }
+                           }});
+        }
+        for (const auto &entry : expressions)
+        {
+            auto exp = std::make_shared<Expression>(entry.second);
+            out.push_back({std::string("parse/") + entry.first, [exp](size_t n) {
+                               for (size_t i = 0; i < n; ++i)
+                               {
+                                   exp->parse();
+                                   keep(exp->ast().size());
+                               }
+                           }});
+        }
+        for (const auto &entry : expressions)
+        {
+            auto exp = std::make_shared<Expression>(entry.second);
+            exp->parse();
+            out.push_back({std::string("eval/tree/") + entry.first, [exp](size_t n) {
+                               for (size_t i = 0; i < n; ++i)
+                               {
+                                   Number value = exp->evaluate();
+                                   keep(value);
+                               }
+                           }});
+        }
+        for (const auto &entry : expressions)
+        {
+            // The vm runs the optimized bytecode, so constant subexpressions
+            // are folded away there
+            Expression exp(entry.second);
+            auto compiled = std::make_shared<CompiledExpression>(exp.compile());
+            exp.parse();
+            std::vector<Number> check;
+            if (exp.evaluate() != compiled->eval(check))
+            {
+                throw std::runtime_error(std::string("vm result differs from the tree for: ") + entry.second);
+            }
+            out.push_back({std::string("eval/vm/") + entry.first, [compiled](size_t n) {
+                               std::vector<Number> stack;
+                               for (size_t i = 0; i < n; ++i)
+                               {
+                                   Number value = compiled->eval(stack);
+                                   keep(value);
+                               }
+                           }});
+        }
+    }
+
+    void addNumberBenchmarks(std::vector<Benchmark> &out)
+    {
+        const Number a = Number(std::string("12345.678"));
+        const Number b = Number(Number::BigRational(22, 7));
+        const Number c = Number::pi(3);
+
+        out.push_back({"number/add", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value = a + b;
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/sub", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value = a - b;
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/mul", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value = a * b;
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/div", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value = a / b;
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/add_irrational", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value = c + c;
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/from_string/integer", [](size_t n) {
+                           const std::string text = "1234567890123";
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value(text);
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/from_string/decimal", [](size_t n) {
+                           const std::string text = "3.14159";
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value(text);
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/from_string/exponent", [](size_t n) {
+                           const std::string text = "6.02214076e23";
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value(text);
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/from_string/hex", [](size_t n) {
+                           const std::string text = "0xDEADBEEF";
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Number value(text);
+                               keep(value);
+                           }
+                       }});
+        out.push_back({"number/approximate", [=](size_t n) {
+                           const Number value = b + c;
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(value.approximate());
+                           }
+                       }});
+        // Constants come from the cache after the first run
+        out.push_back({"number/approximate/1000_bits", [=](size_t n) {
+                           const Number value = b + c;
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(value.approximate(1000));
+                           }
+                       }});
+        out.push_back({"number/compare/rational", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(a < b);
+                           }
+                       }});
+        out.push_back({"number/compare/irrational", [=](size_t n) {
+                           const Number value = b + c;
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(value < a);
+                           }
+                       }});
+        // Agrees with 3π to 200 bits, past what the double estimate can tell
+        out.push_back({"number/compare/near", [=](size_t n) {
+                           const Number near = Number(c.approximate(200));
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(c < near);
+                           }
+                       }});
+    }
+
+    void addFormatBenchmarks(std::vector<Benchmark> &out)
+    {
+        const Number repeating = Number(Number::BigRational(22, 7));
+        const Number rounded = Number(Number::BigRational(1, 9973));
+        const Number symbolic = Number(Number::BigRational(1, 3)) + Number::pi(2);
+        const Number huge = Number(Number::BigRational(boost::multiprecision::pow(boost::multiprecision::cpp_int(3), 200000)));
+
+        out.push_back({"format/repeating", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(NumberFormat::number(repeating));
+                           }
+                       }});
+        out.push_back({"format/rounded", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(NumberFormat::number(rounded));
+                           }
+                       }});
+        out.push_back({"format/symbolic", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(NumberFormat::number(symbolic));
+                           }
+                       }});
+        out.push_back({"format/hex", [=](size_t n) {
+                           FormatOptions options;
+                           options.radix = 16;
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(NumberFormat::number(repeating, options));
+                           }
+                       }});
+        // 95k digits, past the point where divide and conquer wins
+        out.push_back({"format/huge_integer", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(NumberFormat::number(huge));
+                           }
+                       }});
+    }
+
+    // Long chains reduced after every operation, as Number does, against
+    // RationalAccumulator, which Expression uses for chains
+    void addChainBenchmarks(std::vector<Benchmark> &out)
+    {
+        const auto fractions = std::make_shared<std::vector<Rational>>(scatteredFractions(2000));
+
+        out.push_back({"chain/sum/per_operation", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Rational sum;
+                               for (const Rational &value : *fractions)
+                               {
+                                   sum += value;
+                               }
+                               keep(sum);
+                           }
+                       }});
+        out.push_back({"chain/sum/accumulated", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               RationalAccumulator sum(0);
+                               for (const Rational &value : *fractions)
+                               {
+                                   sum.add(value);
+                               }
+                               keep(sum.result());
+                           }
+                       }});
+        out.push_back({"chain/product/per_operation", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               Rational product = 1;
+                               for (const Rational &value : *fractions)
+                               {
+                                   product *= value;
+                               }
+                               keep(product);
+                           }
+                       }});
+        out.push_back({"chain/product/accumulated", [=](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               RationalAccumulator product(1);
+                               for (const Rational &value : *fractions)
+                               {
+                                   product.multiply(value);
+                               }
+                               keep(product.result());
+                           }
+                       }});
+    }
+
+    // Parse and evaluate together, as a user entry would
+    void addMacroBenchmarks(std::vector<Benchmark> &out)
+    {
+        const std::pair<const char *, std::string> workloads[] = {
+            {"macro/deep_nesting", deepNesting(500)},
+            {"macro/long_sum", longSum(10000)},
+            {"macro/harmonic_sum", harmonicSum(2000)},
+            {"macro/huge_literals",
+             hugeLiteral(2000, '1') + " + " + hugeLiteral(2000, '3') + " - " + hugeLiteral(1500, '9')},
+        };
+        for (const auto &workload : workloads)
+        {
+            std::string text = workload.second;
+            out.push_back({workload.first, [text](size_t n) {
+                               for (size_t i = 0; i < n; ++i)
+                               {
+                                   Expression exp(text);
+                                   Number value = exp.eval();
+                                   keep(value);
+                               }
+                           }});
+        }
+
+        auto cache = std::make_shared<ExpressionCache>();
+        out.push_back({"macro/cache_hit", [cache](size_t n) {
+                           for (size_t i = 0; i < n; ++i)
+                           {
+                               keep(cache->eval("(1 + 2) * (3 + 4) - 5 / 6").text.size());
+                           }
+                       }});
+    }
+
+    // One formula over many rows: per-row VM calls, block-at-a-time
+    // evaluation and native code
+    void addRowBenchmarks(std::vector<Benchmark> &out)
+    {
+        const size_t rows = 4096;
+        struct Rows
+        {
+            Environment env;
+            std::vector<double> xs, ys, doubleOut;
+            std::vector<Number> nxs, nys, numberOut;
+        };
+        auto data = std::make_shared<Rows>();
+        data->env.set("x", 0);
+        data->env.set("y", 0);
+        Expression formula("(x * 3 - y / 2) * x + (x < y)", data->env);
+        auto compiled = std::make_shared<CompiledExpression>(formula.compile());
+        auto batch = std::make_shared<BatchEvaluator>(formula);
+        auto jit = std::make_shared<JitExpression>(*compiled);
+
+        data->doubleOut.resize(rows);
+        data->numberOut.resize(rows);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            data->xs.push_back(static_cast<double>(i % 101));
+            data->ys.push_back(static_cast<double>(i % 37));
+            data->nxs.push_back(Number(static_cast<int>(i % 101)));
+            data->nys.push_back(Number(static_cast<int>(i % 37)));
+
+            // Native code must match the double interpreter bit for bit
+            double variables[2] = {data->xs[i] / 7, data->ys[i] / 3};
+            if (!jit->verify(variables))
+            {
+                throw std::runtime_error("jit result differs from the interpreter at row " + std::to_string(i));
+            }
+        }
+
+        out.push_back({"rows/vm_per_row",
+                       [data, compiled](size_t n) {
+                           std::vector<Number> stack;
+                           for (size_t pass = 0; pass < n; ++pass)
+                           {
+                               for (size_t i = 0; i < data->nxs.size(); ++i)
+                               {
+                                   data->env[0] = data->nxs[i];
+                                   data->env[1] = data->nys[i];
+                                   Number value = compiled->eval(stack);
+                                   keep(value);
+                               }
+                           }
+                       },
+                       rows});
+        out.push_back({"rows/batch_number",
+                       [data, batch](size_t n) {
+                           const Number *columns[] = {data->nxs.data(), data->nys.data()};
+                           for (size_t pass = 0; pass < n; ++pass)
+                           {
+                               batch->eval(columns, data->nxs.size(), data->numberOut.data());
+                               keep(data->numberOut[0]);
+                           }
+                       },
+                       rows});
+        out.push_back({"rows/batch_double",
+                       [data, batch](size_t n) {
+                           const double *columns[] = {data->xs.data(), data->ys.data()};
+                           for (size_t pass = 0; pass < n; ++pass)
+                           {
+                               batch->eval(columns, data->xs.size(), data->doubleOut.data());
+                               keep(data->doubleOut[0]);
+                           }
+                       },
+                       rows});
+        out.push_back({"rows/double_interp",
+                       [data, jit](size_t n) {
+                           std::vector<double> stack;
+                           double variables[2];
+                           for (size_t pass = 0; pass < n; ++pass)
+                           {
+                               for (size_t i = 0; i < data->xs.size(); ++i)
+                               {
+                                   variables[0] = data->xs[i];
+                                   variables[1] = data->ys[i];
+                                   keep(jit->interpret(stack, variables));
+                               }
+                           }
+                       },
+                       rows});
+        out.push_back({std::string("rows/jit_") + (jit->compiled() ? "native" : "fallback"),
+                       [data, jit](size_t n) {
+                           std::vector<double> stack;
+                           double variables[2];
+                           for (size_t pass = 0; pass < n; ++pass)
+                           {
+                               for (size_t i = 0; i < data->xs.size(); ++i)
+                               {
+                                   variables[0] = data->xs[i];
+                                   variables[1] = data->ys[i];
+                                   keep(jit->eval(stack, variables));
+                               }
+                           }
+                       },
+                       rows});
+    }
+
+    // Random expression over x and y using every operator JitExpression
+    // translates, depth levels deep
+    std::string randomExpression(std::mt19937 &random, int depth)
+    {
+        static const char *const leaves[] = {"x", "y", "x", "y", "0", "1", "2.5", "1/3", "pi"};
+        static const char *const binary[] = {" + ", " - ", " * ", " / ", " && ", " || ",
+                                             " == ", " != ", " < ", " <= ", " > ", " >= "};
+        std::uniform_int_distribution<int> pick(0, 99);
+        int choice = pick(random);
+        if (depth == 0 || choice < 20)
+        {
+            return leaves[random() % std::size(leaves)];
+        }
+        if (choice < 30)
+        {
+            return "-(" + randomExpression(random, depth - 1) + ")";
+        }
+        if (choice < 35)
+        {
+            return std::string("(") + (random() % 2 ? "x" : "y") + " = " + randomExpression(random, depth - 1) + ")";
+        }
+        if (choice < 40)
+        {
+            // The same subtree twice, shared through a temporary
+            std::string shared = "(" + randomExpression(random, depth - 1) + ")";
+            return "(" + shared + binary[random() % std::size(binary)] + shared + ")";
+        }
+        return "(" + randomExpression(random, depth - 1) + binary[random() % std::size(binary)] +
+               randomExpression(random, depth - 1) + ")";
+    }
+
+    // Checks that generated code and the double interpreter agree bit for
+    // bit, results and assigned variables, on random expressions covering
+    // every opcode and on inputs with signed zeros, infinities, NaN and
+    // denormals. Returns the number of mismatches.
+    size_t verifyJit()
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const double inputs[] = {0.0, -0.0, inf, -inf, nan, -nan, DBL_TRUE_MIN, -DBL_TRUE_MIN, DBL_MIN / 2,
+                                 DBL_MAX, -DBL_MAX, 1.0, -1.0, 0.1, 3.0};
+
+        std::mt19937 random(1);
+        Environment env;
+        env.set("x", 0);
+        env.set("y", 0);
+        std::set<OpCode> covered;
+        size_t expressions = 0, jitted = 0, checks = 0, mismatches = 0;
+        for (int i = 0; i < 4000; ++i)
+        {
+            std::string text = randomExpression(random, 1 + i % 4);
+            Expression formula(text, env);
+            CompiledExpression compiled = formula.compile();
+            JitExpression jit(compiled);
+            expressions++;
+            if (!jit.compiled())
+            {
+                continue;
+            }
+            jitted++;
+            for (const Instruction &ins : compiled.code())
+            {
+                covered.insert(ins.op);
+            }
+            for (double x : inputs)
+            {
+                for (double y : inputs)
+                {
+                    double variables[2] = {x, y};
+                    checks++;
+                    if (!jit.verify(variables))
+                    {
+                        if (mismatches++ < 10)
+                        {
+                            std::fprintf(stderr, "jit differs: %s with x = %g, y = %g\n", text.c_str(), x, y);
+                        }
+                    }
+                }
+            }
+        }
+
+        // OpCode::NONE is never emitted
+        for (int op = static_cast<int>(OpCode::PUSH_CONST); op <= static_cast<int>(OpCode::GE); ++op)
+        {
+            if (!covered.count(static_cast<OpCode>(op)))
+            {
+                std::fprintf(stderr, "opcode %d not covered\n", op);
+                mismatches++;
+            }
+        }
+        std::printf("%zu expressions, %zu translated (%s), %zu checks, %zu mismatches\n", expressions, jitted,
+                    JitExpression::supported() ? "native" : "interpreter only", checks, mismatches);
+        return mismatches;
+    }
+
+    void writeJson(std::ostream &out, const std::vector<Result> &results)
+    {
+        // Benchmark names are plain identifiers, no escaping needed
+        out << "{\n  \"simd\": \"" << BatchEvaluator::simdLevel() << "\",\n";
+        out << "  \"jit\": " << (JitExpression::supported() ? "true" : "false") << ",\n";
+        out << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            char ns[64];
+            std::snprintf(ns, sizeof(ns), "%.3f", results[i].nsPerOp);
+            out << "    {\"name\": \"" << results[i].name << "\", \"ns_per_op\": " << ns
+                << ", \"iterations\": " << results[i].iterations << "}" << (i + 1 < results.size() ? "," : "")
+                << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Reads the name and ns_per_op pairs of a file written by writeJson()
+    std::map<std::string, double> readBaseline(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            throw std::runtime_error("Cannot open baseline " + path);
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const std::string text = buffer.str();
+
+        std::map<std::string, double> baseline;
+        const std::string nameKey = "\"name\": \"";
+        const std::string nsKey = "\"ns_per_op\": ";
+        size_t pos = 0;
+        while ((pos = text.find(nameKey, pos)) != std::string::npos)
+        {
+            pos += nameKey.size();
+            size_t end = text.find('"', pos);
+            size_t ns = end == std::string::npos ? end : text.find(nsKey, end);
+            if (ns == std::string::npos)
+            {
+                break;
+            }
+            baseline[text.substr(pos, end - pos)] = std::strtod(text.c_str() + ns + nsKey.size(), nullptr);
+            pos = ns;
+        }
+        return baseline;
+    }
+
+    void printUsage(const char *name)
+    {
+        std::fprintf(stderr,
+                     "usage: %s [--filter text] [--json file|-] [--baseline file] [--threshold percent]\n"
+                     "       [--min-time ms] [--repetitions n] [--list] [--verify]\n"
+                     "Runs the benchmarks whose name contains the filter text. Given a baseline\n"
+                     "written by --json, benchmarks slower by more than the threshold (default\n"
+                     "10%%) are reported and the exit code is 1. --verify instead checks the\n"
+                     "native code of JitExpression against its interpreter, exit code 1 on a\n"
+                     "mismatch.\n",
+                     name);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+        {
+            options.filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+        {
+            options.jsonPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue)
+        {
+            options.baselinePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue)
+        {
+            options.threshold = std::strtod(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue)
+        {
+            options.minTimeMs = std::max(1.0, std::strtod(argv[++i], nullptr));
+        }
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue)
+        {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--list") == 0)
+        {
+            options.list = true;
+        }
+        else if (std::strcmp(argv[i], "--verify") == 0)
+        {
+            options.verify = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (options.verify)
+    {
+        try
+        {
+            return verifyJit() == 0 ? 0 : 1;
+        }
+        catch (const std::exception &e)
+        {
+            std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+            return 1;
+        }
+    }
+
+    std::vector<Benchmark> benchmarks;
+    std::map<std::string, double> baseline;
+    try
+    {
+        addExpressionBenchmarks(benchmarks);
+        addNumberBenchmarks(benchmarks);
+        addFormatBenchmarks(benchmarks);
+        addChainBenchmarks(benchmarks);
+        addMacroBenchmarks(benchmarks);
+        addRowBenchmarks(benchmarks);
+        if (!options.baselinePath.empty())
+        {
+            baseline = readBaseline(options.baselinePath);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        return 1;
+    }
+
+    if (options.list)
+    {
+        for (const Benchmark &benchmark : benchmarks)
+        {
+            std::printf("%s\n", benchmark.name.c_str());
+        }
+        return 0;
+    }
+
+    // With the JSON on stdout the table goes to stderr
+    FILE *table = options.jsonPath == "-" ? stderr : stdout;
+    std::vector<Result> results;
+    size_t regressions = 0;
+
+    std::fprintf(table, "%-32s %14s %12s %10s\n", "benchmark", "ns/op", "iterations", baseline.empty() ? "" : "vs base");
+    for (const Benchmark &benchmark : benchmarks)
+    {
+        if (benchmark.name.find(options.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        Result result = measure(benchmark, options);
+        results.push_back(result);
+        std::fprintf(table, "%-32s %14.2f %12zu", result.name.c_str(), result.nsPerOp, result.iterations);
+
+        auto base = baseline.find(result.name);
+        if (base != baseline.end() && base->second > 0)
+        {
+            double change = (result.nsPerOp / base->second - 1) * 100;
+            bool regressed = change > options.threshold;
+            regressions += regressed;
+            std::fprintf(table, " %+9.1f%%%s", change, regressed ? "  REGRESSION" : "");
+        }
+        std::fprintf(table, "\n");
+        std::fflush(table);
+    }
+
+    if (options.jsonPath == "-")
+    {
+        writeJson(std::cout, results);
+    }
+    else if (!options.jsonPath.empty())
+    {
+        std::ofstream out(options.jsonPath);
+        writeJson(out, results);
+        if (!out)
+        {
+            std::fprintf(stderr, "%s: cannot write %s\n", argv[0], options.jsonPath.c_str());
+            return 1;
+        }
+    }
+
+    if (regressions)
+    {
+        std::fprintf(stderr, "%zu benchmarks regressed by more than %.1f%%\n", regressions, options.threshold);
+        return 1;
+    }
+    return 0;
+}
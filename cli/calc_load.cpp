@@ -0,0 +1,209 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           calc_load.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Load generator for calc-server
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+struct ConnectionResult
+{
+    std::vector<double> latencies; // microseconds
+    size_t errors = 0;
+    bool failed = false;
+};
+
+// Keeps up to depth requests in flight on one connection and times each
+// from its send to the arrival of its answer line
+static void runConnection(const std::string &path, const std::string &expression, size_t requests, size_t depth,
+                          ConnectionResult &result)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        result.failed = true;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return;
+    }
+
+    const std::string line = expression + "\n";
+    std::deque<Clock::time_point> sent;
+    std::string out;
+    std::string in;
+    char buffer[16384];
+    size_t issued = 0;
+    result.latencies.reserve(requests);
+
+    while (result.latencies.size() < requests)
+    {
+        out.clear();
+        while (issued < requests && sent.size() < depth)
+        {
+            out += line;
+            sent.push_back(Clock::now());
+            issued++;
+        }
+        if (!out.empty() && send(fd, out.data(), out.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(out.size()))
+        {
+            result.failed = true;
+            break;
+        }
+
+        ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+        if (got <= 0)
+        {
+            result.failed = true;
+            break;
+        }
+        in.append(buffer, static_cast<size_t>(got));
+        auto now = Clock::now();
+
+        size_t begin = 0;
+        size_t end;
+        while ((end = in.find('\n', begin)) != std::string::npos)
+        {
+            result.errors += in.compare(begin, 6, "Error:") == 0;
+            result.latencies.push_back(std::chrono::duration<double, std::micro>(now - sent.front()).count());
+            sent.pop_front();
+            begin = end + 1;
+        }
+        in.erase(0, begin);
+    }
+    close(fd);
+}
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    return sorted[index];
+}
+
+int main(int argc, char **argv)
+{
+    size_t connections = 4;
+    size_t requests = 10000;
+    size_t depth = 32;
+    std::string expression = "(1 + 2) * 3 / 7 - 1 / 3";
+    std::string path;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            connections = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            requests = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+        {
+            depth = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            expression = argv[++i];
+        }
+        else if (argv[i][0] != '-' && path.empty())
+        {
+            path = argv[i];
+        }
+        else
+        {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty())
+    {
+        std::fprintf(stderr,
+                     "usage: %s [-c connections] [-n requests per connection] [-d pipeline depth]\n"
+                     "       [-e expression] socket\n",
+                     argv[0]);
+        return 2;
+    }
+
+    std::vector<ConnectionResult> results(connections);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t i = 0; i < connections; ++i)
+    {
+        threads.emplace_back(runConnection, path, expression, requests, depth, std::ref(results[i]));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latencies;
+    size_t errors = 0;
+    size_t failed = 0;
+    for (const ConnectionResult &result : results)
+    {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+        failed += result.failed;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::printf("%zu requests over %zu connections, pipeline depth %zu\n", latencies.size(), connections, depth);
+    std::printf("  throughput %12.0f requests/sec\n", seconds > 0 ? latencies.size() / seconds : 0);
+    std::printf("  p50        %12.1f us\n", percentile(latencies, 0.50));
+    std::printf("  p99        %12.1f us\n", percentile(latencies, 0.99));
+    std::printf("  max        %12.1f us\n", latencies.empty() ? 0 : latencies.back());
+    std::printf("  errors     %12zu\n", errors);
+    if (failed)
+    {
+        std::fprintf(stderr, "%zu connections failed\n", failed);
+        return 1;
+    }
+    return 0;
+}
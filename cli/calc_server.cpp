@@ -0,0 +1,104 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           calc_server.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Evaluation server daemon
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "EvalServer.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static EvalServer *server = nullptr;
+
+static void onSignal(int)
+{
+    if (server)
+    {
+        server->stop();
+    }
+}
+
+static void printUsage(const char *name)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-j threads] [-t timeout_ms] [-q queue_limit] socket\n"
+                 "Answers every line received on the Unix socket with the result of\n"
+                 "the expression on it, in request order.\n",
+                 name);
+}
+
+int main(int argc, char **argv)
+{
+    ServerOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            options.timeout = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "-q") == 0 && i + 1 < argc)
+        {
+            options.queueLimit = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argv[i][0] == '-' || !options.socketPath.empty())
+        {
+            printUsage(argv[0]);
+            return 2;
+        }
+        else
+        {
+            options.socketPath = argv[i];
+        }
+    }
+    if (options.socketPath.empty())
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    try
+    {
+        EvalServer evalServer(options);
+        server = &evalServer;
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        evalServer.run();
+        server = nullptr;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           AsyncEvaluator.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Background evaluation of entered expressions
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "AsyncEvaluator.h"
+
+AsyncEvaluator::AsyncEvaluator()
+{
+    m_Cache.setCancelFlag(&m_Cancel);
+    m_Cache.setEnvironment(m_Env);
+    m_Thread = std::thread([this]() { worker(); });
+}
+
+AsyncEvaluator::~AsyncEvaluator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Cancel = true;
+    m_Changed.notify_one();
+    m_Thread.join();
+}
+
+uint64_t AsyncEvaluator::submit(const std::string &text)
+{
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Text = text;
+        id = ++m_Submitted;
+        m_HasResult = false;
+        // Set under the lock, so it cannot cancel the evaluation of this text
+        m_Cancel = true;
+    }
+    m_Changed.notify_one();
+    return id;
+}
+
+void AsyncEvaluator::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Answered == m_Submitted)
+    {
+        return;
+    }
+    if (m_Started == m_Submitted)
+    {
+        m_Cancel = true;
+        return;
+    }
+    // Not picked up by the worker yet, answer it right away
+    m_Started = m_Submitted;
+    m_Answered = m_Submitted;
+    m_Result = Result();
+    m_Result.id = m_Submitted;
+    m_Result.status = Status::CANCELLED;
+    m_HasResult = true;
+}
+
+bool AsyncEvaluator::poll(Result &result)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_HasResult)
+    {
+        return false;
+    }
+    result = std::move(m_Result);
+    m_HasResult = false;
+    return true;
+}
+
+bool AsyncEvaluator::busy()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_HasResult || m_Answered != m_Submitted;
+}
+
+std::chrono::steady_clock::duration AsyncEvaluator::elapsed()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Started != m_Submitted || m_Answered == m_Submitted)
+    {
+        return std::chrono::steady_clock::duration::zero();
+    }
+    return std::chrono::steady_clock::now() - m_StartTime;
+}
+
+void AsyncEvaluator::setResultCallback(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_ResultCallback = std::move(callback);
+}
+
+CacheStats AsyncEvaluator::astStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ASTStats;
+}
+
+CacheStats AsyncEvaluator::resultStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ResultStats;
+}
+
+Environment AsyncEvaluator::variables()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Variables;
+}
+
+void AsyncEvaluator::worker()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_Changed.wait(lock, [&]() { return m_Stop || m_Started != m_Submitted; });
+        if (m_Stop)
+        {
+            return;
+        }
+
+        uint64_t id = m_Submitted;
+        std::string text = m_Text;
+        m_Started = id;
+        m_StartTime = std::chrono::steady_clock::now();
+        m_Cancel = false;
+        lock.unlock();
+
+        Result result;
+        result.id = id;
+        try
+        {
+            result.text = m_Cache.eval(text).text;
+        }
+        catch (const EvaluationCancelled &)
+        {
+            result.status = Status::CANCELLED;
+        }
+        catch (const std::exception &e)
+        {
+            result.status = Status::ERROR;
+            result.text = e.what();
+        }
+
+        lock.lock();
+        m_ASTStats = m_Cache.astStats();
+        m_ResultStats = m_Cache.resultStats();
+        m_Variables = m_Env;
+        if (id != m_Submitted)
+        {
+            // Replaced by a newer submit() while it was running
+            continue;
+        }
+        m_Answered = id;
+        m_Result = std::move(result);
+        m_HasResult = true;
+        if (m_ResultCallback)
+        {
+            std::function<void()> callback = m_ResultCallback;
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           AsyncEvaluator.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Background evaluation of entered expressions
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _ASYNC_EVALUATOR_H_
+#define _ASYNC_EVALUATOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ExpressionCache.h"
+
+// Evaluates entered expressions on a worker thread, so a long computation
+// does not stop the window from drawing. One expression is evaluated at a
+// time, the UI submits it, polls for the result every frame and can cancel
+// it at any time. Variables assigned by one expression stay set for the
+// ones after it.
+class AsyncEvaluator
+{
+public:
+    enum class Status
+    {
+        OK,
+        ERROR,
+        CANCELLED
+    };
+
+    struct Result
+    {
+        uint64_t id = 0; // returned by the submit() it answers
+        Status status = Status::OK;
+        std::string text; // formatted value or error message
+    };
+
+    AsyncEvaluator();
+    ~AsyncEvaluator();
+
+    AsyncEvaluator(const AsyncEvaluator &) = delete;
+    AsyncEvaluator &operator=(const AsyncEvaluator &) = delete;
+
+    // Starts evaluating text, cancelling the evaluation in progress. Returns
+    // the id of the result.
+    uint64_t submit(const std::string &text);
+
+    // The evaluation in progress finishes with Status::CANCELLED
+    void cancel();
+
+    // Takes the finished result, returns false if there is none. Never
+    // waits for the worker.
+    bool poll(Result &result);
+
+    // True from submit() until its result has been taken with poll()
+    bool busy();
+
+    // Time since the evaluation in progress started
+    std::chrono::steady_clock::duration elapsed();
+
+    // Called on the worker thread when a result is ready
+    void setResultCallback(std::function<void()> callback);
+
+    // Copies of the statistics of the cache used by the worker
+    CacheStats astStats();
+    CacheStats resultStats();
+
+    // Copy of the variables as of the last result
+    Environment variables();
+
+private:
+    void worker();
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+    std::string m_Text;
+    uint64_t m_Submitted = 0;
+    uint64_t m_Started = 0;  // id picked up by the worker
+    uint64_t m_Answered = 0; // id of the last result
+    std::chrono::steady_clock::time_point m_StartTime;
+    Result m_Result;
+    bool m_HasResult = false;
+    bool m_Stop = false;
+    std::function<void()> m_ResultCallback;
+    CacheStats m_ASTStats;
+    CacheStats m_ResultStats;
+    Environment m_Variables;
+    std::atomic<bool> m_Cancel{false};
+    ExpressionCache m_Cache; // only used by the worker
+    Environment m_Env;       // only used by the worker
+    std::thread m_Thread;
+};
+
+#endif
@@ -0,0 +1,465 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           BatchEvaluator.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Block-at-a-time evaluation with SIMD double kernels
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "BatchEvaluator.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CALC_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    enum class SimdLevel
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    SimdLevel detectSimdLevel()
+    {
+#ifdef CALC_BATCH_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return SimdLevel::SSE2;
+        }
+#endif
+        return SimdLevel::SCALAR;
+    }
+
+    const SimdLevel activeSimdLevel = detectSimdLevel();
+
+    // One struct per opcode, each providing the scalar form and, on x86, the
+    // SSE2 and AVX2 forms of the operation
+#ifdef CALC_BATCH_X86
+#define CALC_AVX2 __attribute__((target("avx2")))
+
+    struct AddOp
+    {
+        static double scalar(double a, double b) { return a + b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+    };
+    struct SubOp
+    {
+        static double scalar(double a, double b) { return a - b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_sub_pd(a, b); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_sub_pd(a, b); }
+    };
+    struct MulOp
+    {
+        static double scalar(double a, double b) { return a * b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+    };
+    struct DivOp
+    {
+        static double scalar(double a, double b) { return a / b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_div_pd(a, b); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_div_pd(a, b); }
+    };
+
+    // Comparisons produce an all-ones mask, and-ing it with 1.0 gives 1.0/0.0
+    struct EqOp
+    {
+        static double scalar(double a, double b) { return a == b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_and_pd(_mm_cmpeq_pd(a, b), _mm_set1_pd(1.0)); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ), _mm256_set1_pd(1.0)); }
+    };
+    struct NeOp
+    {
+        static double scalar(double a, double b) { return a != b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_and_pd(_mm_cmpneq_pd(a, b), _mm_set1_pd(1.0)); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_NEQ_UQ), _mm256_set1_pd(1.0)); }
+    };
+    struct LtOp
+    {
+        static double scalar(double a, double b) { return a < b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_and_pd(_mm_cmplt_pd(a, b), _mm_set1_pd(1.0)); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ), _mm256_set1_pd(1.0)); }
+    };
+    struct LeOp
+    {
+        static double scalar(double a, double b) { return a <= b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_and_pd(_mm_cmple_pd(a, b), _mm_set1_pd(1.0)); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ), _mm256_set1_pd(1.0)); }
+    };
+    struct GtOp
+    {
+        static double scalar(double a, double b) { return a > b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_and_pd(_mm_cmpgt_pd(a, b), _mm_set1_pd(1.0)); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ), _mm256_set1_pd(1.0)); }
+    };
+    struct GeOp
+    {
+        static double scalar(double a, double b) { return a >= b; }
+        static __m128d sse2(__m128d a, __m128d b) { return _mm_and_pd(_mm_cmpge_pd(a, b), _mm_set1_pd(1.0)); }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b) { return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ), _mm256_set1_pd(1.0)); }
+    };
+    struct AndOp
+    {
+        static double scalar(double a, double b) { return a != 0 && b != 0; }
+        static __m128d sse2(__m128d a, __m128d b)
+        {
+            __m128d zero = _mm_setzero_pd();
+            __m128d mask = _mm_and_pd(_mm_cmpneq_pd(a, zero), _mm_cmpneq_pd(b, zero));
+            return _mm_and_pd(mask, _mm_set1_pd(1.0));
+        }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b)
+        {
+            __m256d zero = _mm256_setzero_pd();
+            __m256d mask = _mm256_and_pd(_mm256_cmp_pd(a, zero, _CMP_NEQ_UQ), _mm256_cmp_pd(b, zero, _CMP_NEQ_UQ));
+            return _mm256_and_pd(mask, _mm256_set1_pd(1.0));
+        }
+    };
+    struct OrOp
+    {
+        static double scalar(double a, double b) { return a != 0 || b != 0; }
+        static __m128d sse2(__m128d a, __m128d b)
+        {
+            __m128d zero = _mm_setzero_pd();
+            __m128d mask = _mm_or_pd(_mm_cmpneq_pd(a, zero), _mm_cmpneq_pd(b, zero));
+            return _mm_and_pd(mask, _mm_set1_pd(1.0));
+        }
+        CALC_AVX2 static __m256d avx2(__m256d a, __m256d b)
+        {
+            __m256d zero = _mm256_setzero_pd();
+            __m256d mask = _mm256_or_pd(_mm256_cmp_pd(a, zero, _CMP_NEQ_UQ), _mm256_cmp_pd(b, zero, _CMP_NEQ_UQ));
+            return _mm256_and_pd(mask, _mm256_set1_pd(1.0));
+        }
+    };
+
+    template <typename Op>
+    CALC_AVX2 void binaryAvx2(double *a, const double *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            _mm256_storeu_pd(a + i, Op::avx2(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        }
+        for (; i < n; ++i)
+        {
+            a[i] = Op::scalar(a[i], b[i]);
+        }
+    }
+
+    template <typename Op>
+    void binarySse2(double *a, const double *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            _mm_storeu_pd(a + i, Op::sse2(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        }
+        for (; i < n; ++i)
+        {
+            a[i] = Op::scalar(a[i], b[i]);
+        }
+    }
+
+    CALC_AVX2 void negAvx2(double *a, size_t n)
+    {
+        const __m256d sign = _mm256_set1_pd(-0.0);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            _mm256_storeu_pd(a + i, _mm256_xor_pd(_mm256_loadu_pd(a + i), sign));
+        }
+        for (; i < n; ++i)
+        {
+            a[i] = -a[i];
+        }
+    }
+
+    void negSse2(double *a, size_t n)
+    {
+        const __m128d sign = _mm_set1_pd(-0.0);
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            _mm_storeu_pd(a + i, _mm_xor_pd(_mm_loadu_pd(a + i), sign));
+        }
+        for (; i < n; ++i)
+        {
+            a[i] = -a[i];
+        }
+    }
+
+#undef CALC_AVX2
+#else
+    struct AddOp { static double scalar(double a, double b) { return a + b; } };
+    struct SubOp { static double scalar(double a, double b) { return a - b; } };
+    struct MulOp { static double scalar(double a, double b) { return a * b; } };
+    struct DivOp { static double scalar(double a, double b) { return a / b; } };
+    struct EqOp { static double scalar(double a, double b) { return a == b; } };
+    struct NeOp { static double scalar(double a, double b) { return a != b; } };
+    struct LtOp { static double scalar(double a, double b) { return a < b; } };
+    struct LeOp { static double scalar(double a, double b) { return a <= b; } };
+    struct GtOp { static double scalar(double a, double b) { return a > b; } };
+    struct GeOp { static double scalar(double a, double b) { return a >= b; } };
+    struct AndOp { static double scalar(double a, double b) { return a != 0 && b != 0; } };
+    struct OrOp { static double scalar(double a, double b) { return a != 0 || b != 0; } };
+#endif
+
+    template <typename Op>
+    void binaryScalar(double *a, const double *b, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = Op::scalar(a[i], b[i]);
+        }
+    }
+
+    template <typename Op>
+    void binaryDouble(double *a, const double *b, size_t n)
+    {
+#ifdef CALC_BATCH_X86
+        if (activeSimdLevel == SimdLevel::AVX2)
+        {
+            binaryAvx2<Op>(a, b, n);
+            return;
+        }
+        if (activeSimdLevel == SimdLevel::SSE2)
+        {
+            binarySse2<Op>(a, b, n);
+            return;
+        }
+#endif
+        binaryScalar<Op>(a, b, n);
+    }
+
+    // Kernels over a block of doubles, a is both the left operand and the result
+    struct DoubleKernels
+    {
+        static void neg(double *a, size_t n)
+        {
+#ifdef CALC_BATCH_X86
+            if (activeSimdLevel == SimdLevel::AVX2)
+            {
+                negAvx2(a, n);
+                return;
+            }
+            if (activeSimdLevel == SimdLevel::SSE2)
+            {
+                negSse2(a, n);
+                return;
+            }
+#endif
+            for (size_t i = 0; i < n; ++i)
+            {
+                a[i] = -a[i];
+            }
+        }
+
+        static void binary(OpCode op, double *a, const double *b, size_t n)
+        {
+            switch (op)
+            {
+            case OpCode::ADD: binaryDouble<AddOp>(a, b, n); break;
+            case OpCode::SUB: binaryDouble<SubOp>(a, b, n); break;
+            case OpCode::MUL: binaryDouble<MulOp>(a, b, n); break;
+            case OpCode::DIV: binaryDouble<DivOp>(a, b, n); break;
+            case OpCode::AND: binaryDouble<AndOp>(a, b, n); break;
+            case OpCode::OR: binaryDouble<OrOp>(a, b, n); break;
+            case OpCode::EQ: binaryDouble<EqOp>(a, b, n); break;
+            case OpCode::NE: binaryDouble<NeOp>(a, b, n); break;
+            case OpCode::LT: binaryDouble<LtOp>(a, b, n); break;
+            case OpCode::LE: binaryDouble<LeOp>(a, b, n); break;
+            case OpCode::GT: binaryDouble<GtOp>(a, b, n); break;
+            case OpCode::GE: binaryDouble<GeOp>(a, b, n); break;
+            default: throw std::runtime_error("Not a binary opcode");
+            }
+        }
+    };
+
+    struct NumberKernels
+    {
+        static void neg(Number *a, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                a[i] = -a[i];
+            }
+        }
+
+        static void binary(OpCode op, Number *a, const Number *b, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                a[i] = applyBinary(op, a[i], b[i]);
+            }
+        }
+    };
+
+    template <typename T, typename Kernels>
+    void runBlocks(const CompiledExpression &code, const T *constants, const T *const *columns,
+                   size_t rows, T *out, size_t blockRows)
+    {
+        const std::vector<Instruction> &instructions = code.code();
+        const uint32_t variableCount = code.variableCount();
+
+        // One block per stack level, plus one per variable the code stores to
+        // and per temporary
+        std::vector<T> stack(code.maxStackDepth() * blockRows);
+        std::vector<T> stored(variableCount * blockRows);
+        std::vector<T> temps(code.tempCount() * blockRows);
+        std::vector<const T *> variables(variableCount);
+
+        for (size_t begin = 0; begin < rows; begin += blockRows)
+        {
+            const size_t n = std::min(blockRows, rows - begin);
+            for (uint32_t slot = 0; slot < variableCount; ++slot)
+            {
+                variables[slot] = columns[slot] ? columns[slot] + begin : nullptr;
+            }
+
+            T *sp = stack.data(); // start of the block above the top of the stack
+            for (const Instruction &ins : instructions)
+            {
+                switch (ins.op)
+                {
+                case OpCode::PUSH_CONST:
+                    std::fill(sp, sp + n, constants[ins.operand]);
+                    sp += blockRows;
+                    break;
+                case OpCode::LOAD_VAR:
+                    std::copy(variables[ins.operand], variables[ins.operand] + n, sp);
+                    sp += blockRows;
+                    break;
+                case OpCode::STORE_VAR:
+                {
+                    T *target = stored.data() + ins.operand * blockRows;
+                    std::copy(sp - blockRows, sp - blockRows + n, target);
+                    variables[ins.operand] = target;
+                    break;
+                }
+                case OpCode::LOAD_TEMP:
+                {
+                    const T *temp = temps.data() + ins.operand * blockRows;
+                    std::copy(temp, temp + n, sp);
+                    sp += blockRows;
+                    break;
+                }
+                case OpCode::STORE_TEMP:
+                    std::copy(sp - blockRows, sp - blockRows + n, temps.data() + ins.operand * blockRows);
+                    break;
+                case OpCode::NEG:
+                    Kernels::neg(sp - blockRows, n);
+                    break;
+                default:
+                    sp -= blockRows;
+                    Kernels::binary(ins.op, sp - blockRows, sp, n);
+                    break;
+                }
+            }
+            std::copy(stack.data(), stack.data() + n, out + begin);
+        }
+    }
+}
+
+BatchEvaluator::BatchEvaluator(Expression &exp)
+    : m_Code(exp.compile())
+{
+    prepare();
+}
+
+BatchEvaluator::BatchEvaluator(CompiledExpression code)
+    : m_Code(std::move(code))
+{
+    prepare();
+}
+
+void BatchEvaluator::prepare()
+{
+    if (m_Code.empty())
+    {
+        throw std::runtime_error("Evaluating an empty compiled expression");
+    }
+    m_DoubleConstants.clear();
+    for (const Number &constant : m_Code.constants())
+    {
+        m_DoubleConstants.push_back(constant.approximate());
+    }
+}
+
+template <typename T>
+void BatchEvaluator::checkColumns(const T *const *columns) const
+{
+    // A variable without a column must be assigned before it is read
+    std::vector<bool> available(m_Code.variableCount());
+    for (uint32_t slot = 0; slot < available.size(); ++slot)
+    {
+        available[slot] = columns[slot] != nullptr;
+    }
+    for (const Instruction &ins : m_Code.code())
+    {
+        if (ins.op == OpCode::STORE_VAR)
+        {
+            available[ins.operand] = true;
+        }
+        else if (ins.op == OpCode::LOAD_VAR && !available[ins.operand])
+        {
+            throw std::runtime_error("No input column for variable slot " + std::to_string(ins.operand));
+        }
+    }
+}
+
+void BatchEvaluator::eval(const double *const *columns, size_t rows, double *out) const
+{
+    checkColumns(columns);
+    runBlocks<double, DoubleKernels>(m_Code, m_DoubleConstants.data(), columns, rows, out, doubleBlockRows);
+}
+
+void BatchEvaluator::eval(const Number *const *columns, size_t rows, Number *out) const
+{
+    checkColumns(columns);
+    runBlocks<Number, NumberKernels>(m_Code, m_Code.constants().data(), columns, rows, out, numberBlockRows);
+}
+
+const char *BatchEvaluator::simdLevel()
+{
+    switch (activeSimdLevel)
+    {
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           BatchEvaluator.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Evaluates one compiled expression over columns of inputs
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _BATCH_EVALUATOR_H_
+#define _BATCH_EVALUATOR_H_
+
+#include <cstddef>
+#include <vector>
+#include "Expression.h"
+
+// Runs the bytecode of an expression a block of rows at a time: every
+// instruction is applied to the whole block before moving to the next one, so
+// dispatch is paid once per block and the double kernels can use SIMD.
+//
+// Inputs are structure-of-arrays: columns has code().variableCount() entries
+// and columns[slot] points to the values of the variable in that environment
+// slot for every row. Slots the expression does not read may be null. The
+// double path evaluates with the approximate value of each constant; the
+// Number path gives the same results as CompiledExpression::eval() per row.
+class BatchEvaluator
+{
+public:
+    // Rows per block, sized so a few stack levels stay in L1/L2
+    static constexpr size_t doubleBlockRows = 1024;
+    static constexpr size_t numberBlockRows = 64;
+
+    explicit BatchEvaluator(Expression &exp);
+    explicit BatchEvaluator(CompiledExpression code);
+
+    void eval(const double *const *columns, size_t rows, double *out) const;
+    void eval(const Number *const *columns, size_t rows, Number *out) const;
+
+    const CompiledExpression &code() const
+    {
+        return m_Code;
+    }
+
+    // Instruction set the double kernels use on this machine: "avx2", "sse2"
+    // or "scalar"
+    static const char *simdLevel();
+
+private:
+    void prepare();
+    template <typename T>
+    void checkColumns(const T *const *columns) const;
+
+    CompiledExpression m_Code;
+    std::vector<double> m_DoubleConstants;
+};
+
+#endif
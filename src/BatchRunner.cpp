@@ -0,0 +1,401 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           BatchRunner.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Parallel evaluation of newline separated expressions
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "BatchRunner.h"
+#include "Expression.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // Lines handed to a worker at a time
+    constexpr size_t blockLines = 64;
+
+    bool isBlank(const std::string &line)
+    {
+        return std::all_of(line.begin(), line.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); });
+    }
+
+    // Whether line has an assignment operator (=, += ... >>=) outside of
+    // ==, !=, <= and >=. May also be true for other text with an = in it.
+    bool mayAssign(const std::string &line)
+    {
+        for (size_t i = line.find('='); i != std::string::npos; i = line.find('=', i + 1))
+        {
+            if (i + 1 < line.size() && line[i + 1] == '=')
+            {
+                i++;
+                continue;
+            }
+            char before = i > 0 ? line[i - 1] : '\0';
+            bool shift = i > 1 && line[i - 2] == before;
+            if (before == '!' || ((before == '<' || before == '>') && !shift))
+            {
+                continue;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Reads up to count lines, returns false once in is exhausted and nothing was read
+    bool readChunk(std::istream &in, std::vector<std::string> &lines, size_t count)
+    {
+        lines.clear();
+        std::string line;
+        while (lines.size() < count && std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            lines.push_back(std::move(line));
+        }
+        return !lines.empty();
+    }
+
+    void writeChunk(std::ostream &out, const std::vector<std::string> &results, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out << results[i] << '\n';
+        }
+    }
+
+    void printUsage(const char *name)
+    {
+        std::fprintf(stderr,
+                     "usage: %s [-j threads] [-q] [--radix N] [--digits N] [--precision N] [--metrics file] [file...]\n"
+                     "Evaluates one expression per line of each file, or of stdin when\n"
+                     "no file or '-' is given, and prints one result per line in order.\n"
+                     "  -j N  worker threads, defaults to the number of cores. Variables\n"
+                     "        assigned on a line are kept for the lines after it: from the\n"
+                     "        first line with an assignment operator on, lines run one at a\n"
+                     "        time, so the results are the same for any N\n"
+                     "  -q    do not print the throughput to stderr\n"
+                     "  --radix N   result radix, 2, 8, 10 or 16, default 10\n"
+                     "  --digits N  fraction digits before a result is rounded, default 20\n"
+                     "  --precision N  significant digits of results that cannot stay exact,\n"
+                     "                 default double; also sets --digits unless given\n"
+                     "  --metrics file  write per-phase timing histograms as JSON\n",
+                     name);
+    }
+}
+
+BatchPool::BatchPool(unsigned threads, FormatOptions format) : m_Format(format)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        m_Threads.emplace_back([this]() { worker(); });
+    }
+}
+
+BatchPool::~BatchPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Work.notify_all();
+    for (std::thread &thread : m_Threads)
+    {
+        thread.join();
+    }
+}
+
+void BatchPool::start(const std::vector<std::string> &lines, std::vector<std::string> &results, bool newStream)
+{
+    // No worker is running, the serial state is only read after the lock
+    if (newStream)
+    {
+        m_Variables.clear();
+        m_Assigned = false;
+    }
+    size_t serialFrom = m_Assigned ? 0 : lines.size();
+    for (size_t i = 0; i < serialFrom; ++i)
+    {
+        if (mayAssign(lines[i]))
+        {
+            serialFrom = i;
+            m_Assigned = true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Lines = &lines;
+        m_Results = &results;
+        m_SerialFrom = serialFrom;
+        m_SerialTaken = serialFrom == lines.size();
+        m_Next = 0;
+        m_Errors = 0;
+        m_Active = threads();
+        m_Generation++;
+    }
+    m_Work.notify_all();
+}
+
+size_t BatchPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Done.wait(lock, [this]() { return m_Active == 0; });
+    return m_Errors;
+}
+
+void BatchPool::worker()
+{
+    Environment env;
+    Expression exp;
+    exp.setEnvironment(env);
+
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_Work.wait(lock, [&]() { return m_Stop || m_Generation != seen; });
+        if (m_Stop)
+        {
+            return;
+        }
+        seen = m_Generation;
+        const std::vector<std::string> &lines = *m_Lines;
+        std::vector<std::string> &results = *m_Results;
+        const size_t serialFrom = m_SerialFrom;
+        lock.unlock();
+
+        size_t errors = 0;
+        auto evaluate = [&](size_t i) {
+            if (isBlank(lines[i]))
+            {
+                results[i].clear();
+                return;
+            }
+            try
+            {
+                exp.set(lines[i]);
+                exp.parse();
+                Number value = exp.evaluate();
+                Metrics::ScopedTimer timer(Metric::FORMAT_NS);
+                results[i] = NumberFormat::number(value, m_Format);
+            }
+            catch (const std::exception &e)
+            {
+                results[i] = std::string("Error: ") + e.what();
+                errors++;
+            }
+        };
+
+        // The lines that may see variables first, they are the slow part
+        if (!m_SerialTaken.exchange(true))
+        {
+            exp.setEnvironment(m_Variables);
+            for (size_t i = serialFrom; i < lines.size(); ++i)
+            {
+                evaluate(i);
+            }
+            exp.setEnvironment(env);
+        }
+        size_t begin;
+        while ((begin = m_Next.fetch_add(blockLines)) < serialFrom)
+        {
+            size_t end = std::min(begin + blockLines, serialFrom);
+            for (size_t i = begin; i < end; ++i)
+            {
+                env.clear();
+                evaluate(i);
+            }
+        }
+        m_Errors += errors;
+
+        lock.lock();
+        if (--m_Active == 0)
+        {
+            m_Done.notify_one();
+        }
+    }
+}
+
+BatchStats evaluateStream(std::istream &in, std::ostream &out, BatchPool &pool, size_t chunkLines)
+{
+    BatchStats stats;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::string> lines[2];
+    std::vector<std::string> results[2];
+    size_t current = 0;
+
+    bool more = readChunk(in, lines[current], chunkLines);
+    if (more)
+    {
+        results[current].resize(lines[current].size());
+        pool.start(lines[current], results[current], true);
+    }
+    while (more)
+    {
+        size_t next = current ^ 1;
+        more = readChunk(in, lines[next], chunkLines);
+
+        stats.errors += pool.wait();
+        stats.expressions += lines[current].size();
+        if (more)
+        {
+            results[next].resize(lines[next].size());
+            pool.start(lines[next], results[next], false);
+        }
+        writeChunk(out, results[current], lines[current].size());
+        current = next;
+    }
+    out.flush();
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+int runBatchCli(int argc, char **argv)
+{
+    BatchOptions options;
+    bool quiet = false;
+    std::string metricsPath;
+    std::vector<std::string> files;
+    size_t precisionDigits = 0;
+    bool digitsGiven = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--radix") == 0 && i + 1 < argc)
+        {
+            options.format.radix = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            if (options.format.radix != 2 && options.format.radix != 8 && options.format.radix != 10 &&
+                options.format.radix != 16)
+            {
+                printUsage(argv[0]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--digits") == 0 && i + 1 < argc)
+        {
+            options.format.maxDigits = std::strtoul(argv[++i], nullptr, 10);
+            digitsGiven = true;
+        }
+        else if (std::strcmp(argv[i], "--precision") == 0 && i + 1 < argc)
+        {
+            precisionDigits = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "-q") == 0)
+        {
+            quiet = true;
+        }
+        else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc)
+        {
+            metricsPath = argv[++i];
+            Metrics::setEnabled(true);
+        }
+        else if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0)
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (argv[i][0] == '-' && argv[i][1] != '\0')
+        {
+            printUsage(argv[0]);
+            return 2;
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty())
+    {
+        files.push_back("-");
+    }
+    if (precisionDigits != 0)
+    {
+        // log2(10) bits per digit, and one more for the rounding
+        Number::setPrecision(static_cast<size_t>(std::ceil(precisionDigits * 3.3219280948873623)) + 1);
+        if (!digitsGiven)
+        {
+            options.format.maxDigits = precisionDigits;
+        }
+    }
+
+    std::ios::sync_with_stdio(false);
+    BatchPool pool(options.threads, options.format);
+    BatchStats total;
+
+    for (const std::string &file : files)
+    {
+        BatchStats stats;
+        if (file == "-")
+        {
+            stats = evaluateStream(std::cin, std::cout, pool, options.chunkLines);
+        }
+        else
+        {
+            std::ifstream in(file);
+            if (!in)
+            {
+                std::fprintf(stderr, "%s: cannot open %s\n", argv[0], file.c_str());
+                return 1;
+            }
+            stats = evaluateStream(in, std::cout, pool, options.chunkLines);
+        }
+        total.expressions += stats.expressions;
+        total.errors += stats.errors;
+        total.seconds += stats.seconds;
+    }
+
+    if (!quiet)
+    {
+        std::fprintf(stderr, "%zu expressions (%zu errors) in %.3f s on %u threads, %.0f expressions/sec\n",
+                     total.expressions, total.errors, total.seconds, pool.threads(), total.throughput());
+    }
+    if (!metricsPath.empty() && !Metrics::writeJson(metricsPath))
+    {
+        std::fprintf(stderr, "%s: cannot write %s\n", argv[0], metricsPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           BatchRunner.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Parallel evaluation of newline separated expressions
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _BATCH_RUNNER_H_
+#define _BATCH_RUNNER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Environment.h"
+#include "NumberFormat.h"
+
+struct BatchOptions
+{
+    unsigned threads = 0;     // 0 uses std::thread::hardware_concurrency()
+    size_t chunkLines = 16384; // lines read ahead and evaluated together
+    FormatOptions format;      // radix and fraction digits of the results
+};
+
+struct BatchStats
+{
+    size_t expressions = 0;
+    size_t errors = 0;
+    double seconds = 0;
+
+    double throughput() const
+    {
+        return seconds > 0 ? expressions / seconds : 0;
+    }
+};
+
+// Thread pool evaluating a vector of lines, each worker with its own
+// Expression. Lines are handed out in small blocks, so a few expensive
+// expressions do not stall the other workers. Results never depend on the
+// thread count: lines before the first one that may assign a variable are
+// evaluated in parallel, as none of them can see a variable. From that line
+// to the end of the stream one worker evaluates the lines in order in one
+// Environment, so `x = 3` on one line sets x for the lines after it.
+class BatchPool
+{
+public:
+    explicit BatchPool(unsigned threads, FormatOptions format = FormatOptions());
+    ~BatchPool();
+
+    BatchPool(const BatchPool &) = delete;
+    BatchPool &operator=(const BatchPool &) = delete;
+
+    // Starts evaluating lines into results, which must be resized to
+    // lines.size(). Both must stay alive until wait() returns. newStream
+    // drops the variables of the lines before, see above.
+    void start(const std::vector<std::string> &lines, std::vector<std::string> &results, bool newStream);
+    // Waits for the last start() and returns the number of lines that failed
+    size_t wait();
+
+    unsigned threads() const
+    {
+        return static_cast<unsigned>(m_Threads.size());
+    }
+
+private:
+    void worker();
+
+    FormatOptions m_Format;
+    std::vector<std::thread> m_Threads;
+    std::mutex m_Mutex;
+    std::condition_variable m_Work;
+    std::condition_variable m_Done;
+    uint64_t m_Generation = 0;
+    unsigned m_Active = 0;
+    bool m_Stop = false;
+    const std::vector<std::string> *m_Lines = nullptr;
+    std::vector<std::string> *m_Results = nullptr;
+    std::atomic<size_t> m_Next{0};
+    std::atomic<size_t> m_Errors{0};
+
+    // Lines from m_SerialFrom on run in order in m_Variables, by the worker
+    // that takes m_SerialTaken first
+    Environment m_Variables;
+    bool m_Assigned = false; // a line of the stream may have assigned
+    size_t m_SerialFrom = 0;
+    std::atomic<bool> m_SerialTaken{true};
+};
+
+// Evaluates every line of in and writes one result line per input line to
+// out, in input order. Variables start empty for every stream. Reading the
+// next chunk and writing the previous one overlap with evaluation.
+BatchStats evaluateStream(std::istream &in, std::ostream &out, BatchPool &pool, size_t chunkLines);
+
+// Command line front end of calc-cli and `calculator --batch`
+int runBatchCli(int argc, char **argv);
+
+#endif
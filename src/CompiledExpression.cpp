@@ -0,0 +1,239 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           CompiledExpression.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Bytecode emitter and stack VM implementation
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "CompiledExpression.h"
+#include <stdexcept>
+#include <algorithm>
+
+Number applyUnary(OpCode op, const Number &operand)
+{
+    switch (op)
+    {
+    case OpCode::NEG:
+        return -operand;
+    default:
+        throw std::runtime_error("Not a unary opcode");
+    }
+}
+
+Number applyBinary(OpCode op, const Number &left, const Number &right)
+{
+    switch (op)
+    {
+    case OpCode::ADD:
+        return left + right;
+    case OpCode::SUB:
+        return left - right;
+    case OpCode::MUL:
+        return left * right;
+    case OpCode::DIV:
+        return left / right;
+    case OpCode::AND:
+        return left && right;
+    case OpCode::OR:
+        return left || right;
+    case OpCode::EQ:
+        return left == right;
+    case OpCode::NE:
+        return left != right;
+    case OpCode::LT:
+        return left < right;
+    case OpCode::LE:
+        return left <= right;
+    case OpCode::GT:
+        return left > right;
+    case OpCode::GE:
+        return left >= right;
+    default:
+        throw std::runtime_error("Not a binary opcode");
+    }
+}
+
+void CompiledExpression::emit(OpCode op, uint32_t operand)
+{
+    m_Code.push_back({op, operand});
+
+    switch (op)
+    {
+    case OpCode::PUSH_CONST:
+        m_StackDepth++;
+        break;
+    case OpCode::LOAD_VAR:
+        m_StackDepth++;
+        m_VariableCount = std::max(m_VariableCount, operand + 1);
+        break;
+    case OpCode::STORE_VAR:
+        // Stores the top of the stack and leaves it there as the result
+        m_VariableCount = std::max(m_VariableCount, operand + 1);
+        break;
+    case OpCode::LOAD_TEMP:
+        m_StackDepth++;
+        m_TempCount = std::max(m_TempCount, operand + 1);
+        break;
+    case OpCode::STORE_TEMP:
+        m_TempCount = std::max(m_TempCount, operand + 1);
+        break;
+    case OpCode::NEG:
+        break;
+    default:
+        // Every other opcode is binary: pops two, pushes one
+        m_StackDepth--;
+        break;
+    }
+    m_MaxStack = std::max(m_MaxStack, m_StackDepth);
+}
+
+void CompiledExpression::emitConstant(Number value)
+{
+    m_Constants.push_back(std::move(value));
+    emit(OpCode::PUSH_CONST, static_cast<uint32_t>(m_Constants.size() - 1));
+}
+
+void CompiledExpression::clear()
+{
+    m_Code.clear();
+    m_Constants.clear();
+    m_StackDepth = 0;
+    m_MaxStack = 0;
+    m_VariableCount = 0;
+    m_TempCount = 0;
+}
+
+Number CompiledExpression::eval() const
+{
+    std::vector<Number> stack;
+    return eval(stack);
+}
+
+Number CompiledExpression::eval(std::vector<Number> &stack) const
+{
+    if (m_VariableCount == 0)
+    {
+        return eval(stack, nullptr);
+    }
+    if (!m_Env || m_Env->size() < m_VariableCount)
+    {
+        throw std::runtime_error("Compiled expression refers to variables of an unbound environment");
+    }
+    return eval(stack, m_Env->data());
+}
+
+Number CompiledExpression::eval(std::vector<Number> &stack, Number *variables) const
+{
+    if (m_Code.empty())
+    {
+        throw std::runtime_error("Evaluating an empty compiled expression");
+    }
+    // Temporaries live after the deepest stack slot
+    if (stack.size() < m_MaxStack + m_TempCount)
+    {
+        stack.resize(m_MaxStack + m_TempCount);
+    }
+
+    Number *sp = stack.data(); // points one past the top of the stack
+    Number *temps = stack.data() + m_MaxStack;
+    const Number *constants = m_Constants.data();
+
+    for (const Instruction &ins : m_Code)
+    {
+        switch (ins.op)
+        {
+        case OpCode::PUSH_CONST:
+            *sp++ = constants[ins.operand];
+            break;
+        case OpCode::LOAD_VAR:
+            *sp++ = variables[ins.operand];
+            break;
+        case OpCode::STORE_VAR:
+            variables[ins.operand] = sp[-1];
+            break;
+        case OpCode::LOAD_TEMP:
+            *sp++ = temps[ins.operand];
+            break;
+        case OpCode::STORE_TEMP:
+            temps[ins.operand] = sp[-1];
+            break;
+        case OpCode::NEG:
+            sp[-1] = -sp[-1];
+            break;
+        case OpCode::ADD:
+            --sp;
+            sp[-1] = sp[-1] + *sp;
+            break;
+        case OpCode::SUB:
+            --sp;
+            sp[-1] = sp[-1] - *sp;
+            break;
+        case OpCode::MUL:
+            --sp;
+            sp[-1] = sp[-1] * *sp;
+            break;
+        case OpCode::DIV:
+            --sp;
+            sp[-1] = sp[-1] / *sp;
+            break;
+        case OpCode::AND:
+            --sp;
+            sp[-1] = sp[-1] && *sp;
+            break;
+        case OpCode::OR:
+            --sp;
+            sp[-1] = sp[-1] || *sp;
+            break;
+        case OpCode::EQ:
+            --sp;
+            sp[-1] = sp[-1] == *sp;
+            break;
+        case OpCode::NE:
+            --sp;
+            sp[-1] = sp[-1] != *sp;
+            break;
+        case OpCode::LT:
+            --sp;
+            sp[-1] = sp[-1] < *sp;
+            break;
+        case OpCode::LE:
+            --sp;
+            sp[-1] = sp[-1] <= *sp;
+            break;
+        case OpCode::GT:
+            --sp;
+            sp[-1] = sp[-1] > *sp;
+            break;
+        case OpCode::GE:
+            --sp;
+            sp[-1] = sp[-1] >= *sp;
+            break;
+        case OpCode::NONE:
+            throw std::runtime_error("Invalid instruction");
+        }
+    }
+    return stack[0];
+}
@@ -0,0 +1,117 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           CompiledExpression.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Bytecode form of a parsed expression and its stack VM
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _COMPILED_EXPRESSION_H_
+#define _COMPILED_EXPRESSION_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Number.h"
+#include "Operators.h"
+#include "Environment.h"
+
+struct Instruction
+{
+    OpCode op;
+    uint32_t operand; // constant pool index for PUSH_CONST, variable slot for
+                      // LOAD_VAR/STORE_VAR, temporary for LOAD_TEMP/STORE_TEMP,
+                      // unused otherwise
+};
+
+// Semantics of the arithmetic opcodes, shared with the AST evaluator
+Number applyUnary(OpCode op, const Number &operand);
+Number applyBinary(OpCode op, const Number &left, const Number &right);
+
+class CompiledExpression
+{
+public:
+    CompiledExpression() {}
+
+    // Runs the bytecode, the stack vector is reused between calls so
+    // repeated evaluations do not reallocate it. Variables are read from and
+    // written to the bound environment.
+    Number eval() const;
+    Number eval(std::vector<Number> &stack) const;
+    // Same, with variable slots taken from a caller provided array of at
+    // least variableCount() Numbers
+    Number eval(std::vector<Number> &stack, Number *variables) const;
+
+    void emit(OpCode op, uint32_t operand = 0);
+    void emitConstant(Number value);
+    void bind(Environment *env)
+    {
+        m_Env = env;
+    }
+    void clear();
+
+    bool empty() const
+    {
+        return m_Code.empty();
+    }
+    const std::vector<Instruction> &code() const
+    {
+        return m_Code;
+    }
+    const std::vector<Number> &constants() const
+    {
+        return m_Constants;
+    }
+    size_t maxStackDepth() const
+    {
+        return m_MaxStack;
+    }
+    // One past the highest variable slot the code refers to
+    uint32_t variableCount() const
+    {
+        return m_VariableCount;
+    }
+    // Temporaries hold shared subexpressions, computed once and reloaded
+    uint32_t tempCount() const
+    {
+        return m_TempCount;
+    }
+    Environment *environment() const
+    {
+        return m_Env;
+    }
+
+private:
+    std::vector<Instruction> m_Code;
+    std::vector<Number> m_Constants;
+    size_t m_StackDepth = 0;
+    size_t m_MaxStack = 0;
+    uint32_t m_VariableCount = 0;
+    uint32_t m_TempCount = 0;
+    Environment *m_Env = nullptr;
+};
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Environment.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Variable environment implementation
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "Environment.h"
+#include <stdexcept>
+
+uint32_t Environment::slot(std::string_view name)
+{
+    auto it = m_Slots.find(name);
+    if (it != m_Slots.end())
+    {
+        return it->second;
+    }
+    uint32_t index = size();
+    m_Slots.emplace(std::string(name), index);
+    m_Names.emplace_back(name);
+    m_Values.emplace_back(0);
+    return index;
+}
+
+uint32_t Environment::find(std::string_view name) const
+{
+    auto it = m_Slots.find(name);
+    return it != m_Slots.end() ? it->second : npos;
+}
+
+void Environment::set(std::string_view name, Number value)
+{
+    m_Values[slot(name)] = std::move(value);
+}
+
+const Number &Environment::get(std::string_view name) const
+{
+    uint32_t index = find(name);
+    if (index == npos)
+    {
+        throw std::runtime_error("Undefined variable: " + std::string(name));
+    }
+    return m_Values[index];
+}
+
+void Environment::clear()
+{
+    m_Slots.clear();
+    m_Names.clear();
+    m_Values.clear();
+}
@@ -0,0 +1,86 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Environment.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Named variables resolved to flat value slots
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _ENVIRONMENT_H_
+#define _ENVIRONMENT_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Number.h"
+
+// Variables live in a flat array of Numbers. Names are only looked up when an
+// expression is parsed, compiled code and the AST refer to variables by slot.
+class Environment
+{
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    // Returns the slot of name, creating it (with value 0) if needed
+    uint32_t slot(std::string_view name);
+    // Returns the slot of name, or npos if it does not exist
+    uint32_t find(std::string_view name) const;
+
+    void set(std::string_view name, Number value);
+    const Number &get(std::string_view name) const;
+
+    Number &operator[](uint32_t slot)
+    {
+        return m_Values[slot];
+    }
+    const Number &operator[](uint32_t slot) const
+    {
+        return m_Values[slot];
+    }
+    Number *data()
+    {
+        return m_Values.data();
+    }
+    uint32_t size() const
+    {
+        return static_cast<uint32_t>(m_Values.size());
+    }
+    const std::string &name(uint32_t slot) const
+    {
+        return m_Names[slot];
+    }
+
+    void clear();
+
+private:
+    std::map<std::string, uint32_t, std::less<>> m_Slots;
+    std::vector<std::string> m_Names;
+    std::vector<Number> m_Values;
+};
+
+#endif
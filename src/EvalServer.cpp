@@ -0,0 +1,534 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           EvalServer.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Expression evaluation server on a Unix domain socket
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "EvalServer.h"
+#include "Expression.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    int64_t toTicks(std::chrono::steady_clock::time_point time)
+    {
+        return time.time_since_epoch().count();
+    }
+
+    void setNonBlocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    std::runtime_error socketError(const std::string &what)
+    {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    // Removes the socket file a server that is gone left at path. Throws
+    // EADDRINUSE for anything else there: another file, or a socket a live
+    // server still accepts connections on.
+    void removeStaleSocket(const sockaddr_un &address)
+    {
+        const std::string path = address.sun_path;
+        struct stat info;
+        if (lstat(path.c_str(), &info) != 0)
+        {
+            if (errno == ENOENT)
+            {
+                return;
+            }
+            throw socketError("stat " + path);
+        }
+        if (!S_ISSOCK(info.st_mode))
+        {
+            errno = EADDRINUSE;
+            throw socketError("bind " + path + ", not a socket");
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe < 0)
+        {
+            throw socketError("socket");
+        }
+        int connected = connect(probe, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+        int error = errno;
+        close(probe);
+        if (connected == 0 || error != ECONNREFUSED)
+        {
+            errno = EADDRINUSE;
+            throw socketError("bind " + path);
+        }
+        unlink(path.c_str());
+    }
+}
+
+struct EvalServer::Session
+{
+    Environment env;
+    bool running = false; // a worker is evaluating one of its jobs, under m_QueueMutex
+};
+
+EvalServer::EvalServer(ServerOptions options) : m_Options(std::move(options))
+{
+    if (m_Options.threads == 0)
+    {
+        m_Options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_Wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_Wake < 0)
+    {
+        throw socketError("eventfd");
+    }
+}
+
+EvalServer::~EvalServer()
+{
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        m_QueueChanged.notify_all();
+    }
+    for (auto &worker : m_Workers)
+    {
+        worker->cancel = true;
+        worker->thread.join();
+    }
+    for (auto &entry : m_Connections)
+    {
+        close(entry.second.fd);
+    }
+    if (m_Listen >= 0)
+    {
+        close(m_Listen);
+    }
+    // Only the file this server bound, not one that replaced it since
+    struct stat info;
+    if (m_SocketFile && lstat(m_Options.socketPath.c_str(), &info) == 0 &&
+        m_SocketFile->first == static_cast<uint64_t>(info.st_dev) &&
+        m_SocketFile->second == static_cast<uint64_t>(info.st_ino))
+    {
+        unlink(m_Options.socketPath.c_str());
+    }
+    close(m_Wake);
+}
+
+void EvalServer::stop()
+{
+    m_Stop = true;
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = write(m_Wake, &one, sizeof(one));
+}
+
+void EvalServer::run()
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (m_Options.socketPath.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("Socket path too long: " + m_Options.socketPath);
+    }
+    std::memcpy(address.sun_path, m_Options.socketPath.c_str(), m_Options.socketPath.size() + 1);
+
+    m_Listen = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_Listen < 0)
+    {
+        throw socketError("socket");
+    }
+    removeStaleSocket(address);
+    if (bind(m_Listen, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        throw socketError("bind " + m_Options.socketPath);
+    }
+    struct stat info;
+    if (lstat(m_Options.socketPath.c_str(), &info) == 0)
+    {
+        m_SocketFile = {static_cast<uint64_t>(info.st_dev), static_cast<uint64_t>(info.st_ino)};
+    }
+    if (listen(m_Listen, SOMAXCONN) < 0)
+    {
+        throw socketError("listen");
+    }
+    setNonBlocking(m_Listen);
+
+    for (unsigned i = 0; i < m_Options.threads; ++i)
+    {
+        m_Workers.push_back(std::make_unique<Worker>());
+        Worker &worker = *m_Workers.back();
+        worker.thread = std::thread([this, &worker]() { work(worker); });
+    }
+
+    std::vector<pollfd> fds;
+    std::vector<uint64_t> ids;
+    while (!m_Stop)
+    {
+        fds.clear();
+        ids.clear();
+        fds.push_back({m_Wake, POLLIN, 0});
+        fds.push_back({m_Listen, POLLIN, 0});
+        for (auto &entry : m_Connections)
+        {
+            Connection &connection = entry.second;
+            short events = 0;
+            // Backpressure: stop reading while this connection has enough
+            // requests in flight or unsent output
+            if (!connection.eof && connection.pending.size() < m_Options.connectionInFlight &&
+                connection.out.size() < m_Options.maxLineLength * 16 &&
+                connection.in.size() < m_Options.maxLineLength)
+            {
+                events |= POLLIN;
+            }
+            if (!connection.out.empty())
+            {
+                events |= POLLOUT;
+            }
+            fds.push_back({connection.fd, events, 0});
+            ids.push_back(entry.first);
+        }
+
+        // Running requests are checked for their timeout on a short tick
+        int timeout = m_InFlight > 0 ? 10 : -1;
+        if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR)
+        {
+            throw socketError("poll");
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            uint64_t count;
+            [[maybe_unused]] ssize_t got = read(m_Wake, &count, sizeof(count));
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            accept();
+        }
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            Connection &connection = m_Connections.at(ids[i]);
+            bool ok = true;
+            if (fds[i + 2].revents & (POLLIN | POLLHUP))
+            {
+                ok = readFrom(connection);
+            }
+            if (ok && (fds[i + 2].revents & POLLOUT))
+            {
+                ok = writeTo(connection);
+            }
+            if (!ok || (fds[i + 2].revents & POLLERR))
+            {
+                close(connection.fd);
+                m_Connections.erase(ids[i]);
+            }
+        }
+
+        complete();
+
+        // Hand out complete lines, round robin so one connection cannot
+        // take the whole queue
+        for (auto it = m_Connections.begin(); it != m_Connections.end();)
+        {
+            Connection &connection = it->second;
+            dispatch(it->first, connection);
+            bool ok = writeTo(connection);
+            bool done = connection.eof && connection.pending.empty() && connection.out.empty();
+            if (!ok || done)
+            {
+                close(connection.fd);
+                it = m_Connections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        cancelExpired();
+    }
+}
+
+void EvalServer::accept()
+{
+    while (true)
+    {
+        int fd = accept4(m_Listen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+        Connection connection;
+        connection.fd = fd;
+        connection.session = std::make_shared<Session>();
+        m_Connections.emplace(m_NextConnection++, std::move(connection));
+    }
+}
+
+bool EvalServer::readFrom(Connection &connection)
+{
+    char buffer[16384];
+    while (connection.in.size() < m_Options.maxLineLength)
+    {
+        ssize_t got = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (got > 0)
+        {
+            connection.in.append(buffer, static_cast<size_t>(got));
+            continue;
+        }
+        if (got == 0)
+        {
+            connection.eof = true;
+            return true;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    return true;
+}
+
+bool EvalServer::writeTo(Connection &connection)
+{
+    while (!connection.out.empty())
+    {
+        ssize_t sent = send(connection.fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        connection.out.erase(0, static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+void EvalServer::dispatch(uint64_t id, Connection &connection)
+{
+    if (connection.skipping)
+    {
+        size_t end = connection.in.find('\n');
+        connection.in.erase(0, end == std::string::npos ? end : end + 1);
+        connection.skipping = end == std::string::npos;
+    }
+
+    size_t begin = 0;
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        while (m_Queue.size() + jobs.size() < m_Options.queueLimit &&
+               connection.pending.size() < m_Options.connectionInFlight)
+        {
+            size_t end = connection.in.find('\n', begin);
+            if (end == std::string::npos)
+            {
+                break;
+            }
+            size_t length = end - begin;
+            if (length > 0 && connection.in[end - 1] == '\r')
+            {
+                length--;
+            }
+            jobs.push_back({id, connection.nextSeq++, connection.in.substr(begin, length),
+                            Clock::now() + m_Options.timeout, connection.session});
+            connection.pending.emplace_back();
+            begin = end + 1;
+        }
+        for (Job &job : jobs)
+        {
+            m_Queue.push_back(std::move(job));
+        }
+    }
+    connection.in.erase(0, begin);
+    m_InFlight += jobs.size();
+    if (jobs.size() == 1)
+    {
+        m_QueueChanged.notify_one();
+    }
+    else if (!jobs.empty())
+    {
+        m_QueueChanged.notify_all();
+    }
+
+    // A line that does not fit in the buffer is answered with an error and
+    // the rest of it is dropped as it arrives
+    if (connection.in.size() >= m_Options.maxLineLength && connection.in.find('\n') == std::string::npos)
+    {
+        connection.in.clear();
+        connection.skipping = true;
+        connection.pending.emplace_back("Error: Request too long");
+        connection.nextSeq++;
+        flush(connection);
+    }
+    if (connection.eof && !connection.in.empty() && connection.in.find('\n') == std::string::npos)
+    {
+        // Last request without a trailing newline
+        connection.in.push_back('\n');
+        dispatch(id, connection);
+    }
+}
+
+void EvalServer::complete()
+{
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_CompletionMutex);
+        completions.swap(m_Completions);
+    }
+    m_InFlight -= completions.size();
+
+    for (Completion &completion : completions)
+    {
+        auto it = m_Connections.find(completion.connection);
+        if (it == m_Connections.end())
+        {
+            continue; // closed while the request was running
+        }
+        Connection &connection = it->second;
+        connection.pending[completion.seq - connection.firstPending] = std::move(completion.text);
+    }
+    for (auto &entry : m_Connections)
+    {
+        flush(entry.second);
+    }
+}
+
+void EvalServer::flush(Connection &connection)
+{
+    // Answers go out in request order, a finished request waits for the
+    // ones before it
+    while (!connection.pending.empty() && connection.pending.front())
+    {
+        connection.out += *connection.pending.front();
+        connection.out += '\n';
+        connection.pending.pop_front();
+        connection.firstPending++;
+    }
+}
+
+void EvalServer::cancelExpired()
+{
+    int64_t now = toTicks(Clock::now());
+    for (auto &worker : m_Workers)
+    {
+        int64_t deadline = worker->deadline.load();
+        if (deadline != 0 && now > deadline)
+        {
+            worker->cancel = true;
+        }
+    }
+}
+
+std::deque<EvalServer::Job>::iterator EvalServer::nextJob()
+{
+    return std::find_if(m_Queue.begin(), m_Queue.end(), [](const Job &job) { return !job.session->running; });
+}
+
+void EvalServer::work(Worker &worker)
+{
+    Expression exp;
+    exp.setCancelFlag(&worker.cancel);
+    std::ostringstream oss;
+
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_QueueMutex);
+            m_QueueChanged.wait(lock, [this]() { return m_Stop || nextJob() != m_Queue.end(); });
+            if (m_Stop)
+            {
+                return;
+            }
+            auto next = nextJob();
+            job = std::move(*next);
+            m_Queue.erase(next);
+            job.session->running = true;
+        }
+        exp.setEnvironment(job.session->env);
+
+        std::string result;
+        if (std::all_of(job.text.begin(), job.text.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); }))
+        {
+            // Blank lines get a blank answer, like in calc-cli
+        }
+        else if (Clock::now() >= job.deadline)
+        {
+            result = "Error: Request timed out";
+        }
+        else
+        {
+            worker.deadline = toTicks(job.deadline);
+            while (true)
+            {
+                worker.cancel = false;
+                try
+                {
+                    exp.set(job.text);
+                    exp.parse();
+                    oss.str(std::string());
+                    oss << exp.evaluate();
+                    result = oss.str();
+                }
+                catch (const EvaluationCancelled &)
+                {
+                    // The I/O thread may cancel a job that finished right
+                    // before it looked, and this one by mistake
+                    if (Clock::now() < job.deadline)
+                    {
+                        continue;
+                    }
+                    result = "Error: Request timed out";
+                }
+                catch (const std::exception &e)
+                {
+                    result = std::string("Error: ") + e.what();
+                }
+                break;
+            }
+            worker.deadline = 0;
+        }
+
+        {
+            // The next job of the session may run now
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            job.session->running = false;
+        }
+        m_QueueChanged.notify_one();
+        {
+            std::lock_guard<std::mutex> lock(m_CompletionMutex);
+            m_Completions.push_back({job.connection, job.seq, std::move(result)});
+        }
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = write(m_Wake, &one, sizeof(one));
+    }
+}
@@ -0,0 +1,163 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           EvalServer.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Expression evaluation server on a Unix domain socket
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _EVAL_SERVER_H_
+#define _EVAL_SERVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct ServerOptions
+{
+    std::string socketPath;
+    unsigned threads = 0; // 0 uses std::thread::hardware_concurrency()
+    std::chrono::milliseconds timeout{1000};
+    size_t queueLimit = 4096;         // requests waiting for a worker, over all connections
+    size_t connectionInFlight = 1024; // requests of one connection not answered yet
+    size_t maxLineLength = 64 * 1024;
+};
+
+// Serves line-delimited requests: every line received is an expression and
+// is answered by one line, the result or "Error: ...", in request order.
+// A client may pipeline any number of requests.
+//
+// Every connection is a session with its own variables: `x = 3` on one
+// line sets x for the lines after it. The requests of a connection are
+// evaluated one at a time and in order, requests of different connections
+// in parallel.
+//
+// One thread does all socket I/O with poll(), a fixed pool of workers, each
+// with its own Expression, evaluates. Reading from a connection pauses while
+// the shared queue or the connection's in-flight requests are at their
+// limit, so a fast client cannot grow the server's memory. Requests still
+// queued or running when their timeout expires are answered with an error,
+// a running evaluation is cancelled through Expression::setCancelFlag().
+class EvalServer
+{
+public:
+    explicit EvalServer(ServerOptions options);
+    ~EvalServer();
+
+    EvalServer(const EvalServer &) = delete;
+    EvalServer &operator=(const EvalServer &) = delete;
+
+    // Binds the socket and serves until stop(). Throws std::runtime_error
+    // if the socket cannot be set up. A socket file left by a server that is
+    // gone is replaced, anything else at the path fails with EADDRINUSE.
+    void run();
+    // Async-signal-safe
+    void stop();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Variables of a connection, shared with its jobs so they outlive it
+    struct Session;
+
+    struct Connection
+    {
+        int fd;
+        std::shared_ptr<Session> session;
+        std::string in;
+        std::string out;
+        uint64_t nextSeq = 0;
+        uint64_t firstPending = 0; // sequence number of pending.front()
+        std::deque<std::optional<std::string>> pending;
+        bool eof = false;
+        bool skipping = false; // dropping the rest of a too long request
+    };
+
+    struct Job
+    {
+        uint64_t connection;
+        uint64_t seq;
+        std::string text;
+        Clock::time_point deadline;
+        std::shared_ptr<Session> session;
+    };
+
+    struct Completion
+    {
+        uint64_t connection;
+        uint64_t seq;
+        std::string text;
+    };
+
+    struct Worker
+    {
+        std::thread thread;
+        std::atomic<bool> cancel{false};
+        std::atomic<int64_t> deadline{0}; // of the running job, 0 when idle
+    };
+
+    void work(Worker &worker);
+    // First queued job whose session is not running another, under m_QueueMutex
+    std::deque<Job>::iterator nextJob();
+    void accept();
+    bool readFrom(Connection &connection);
+    bool writeTo(Connection &connection);
+    void dispatch(uint64_t id, Connection &connection);
+    void complete();
+    void flush(Connection &connection);
+    void cancelExpired();
+
+    ServerOptions m_Options;
+    int m_Listen = -1;
+    std::optional<std::pair<uint64_t, uint64_t>> m_SocketFile; // device and inode of the bound socket
+    int m_Wake = -1; // eventfd, signalled by workers and stop()
+    std::atomic<bool> m_Stop{false};
+
+    std::unordered_map<uint64_t, Connection> m_Connections;
+    uint64_t m_NextConnection = 0;
+    size_t m_InFlight = 0; // dispatched and not completed, only used by the I/O thread
+
+    std::mutex m_QueueMutex;
+    std::condition_variable m_QueueChanged;
+    std::deque<Job> m_Queue;
+
+    std::mutex m_CompletionMutex;
+    std::vector<Completion> m_Completions;
+
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+};
+
+#endif
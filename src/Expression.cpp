@@ -29,188 +29,515 @@
  * -----------------------------------------------------------------------------
  */
 #include "Expression.h"
-#include <unordered_map>
+#include "Metrics.h"
+#include "NumberLiteral.h"
+#include "RationalAccumulator.h"
 #include <cstdint>
-#include <set>
+#include <cctype>
+#include <algorithm>
 
 int getPrecedence(const Token &token)
 {
-    const std::unordered_map<std::string, int> precedence = {
-        {"++", 15}, {"--", 15}, {"*", 14}, {"/", 14}, {"%", 14},
-        {"+", 13}, {"-", 13}, {"<<", 12}, {">>", 12}, {"<", 11}, {">", 11}, {"<=", 11}, {">=", 11},
-        {"==", 10}, {"!=", 10}, {"&", 9}, {"^", 8}, {"|", 7}, {"&&", 6}, {"||", 5}, {"?", 4}, {":", 4},
-        {"=", 3}, {"+=", 3}, {"-=", 3}, {"*=", 3}, {"/=", 3}, {"%=", 3}, {"<<=", 3}, {">>=", 3},
-        {"&=", 3}, {"^=", 3}, {"|=", 3}, {",", 2},
-    };
+    return token.precedence;
+}
 
-    if (token.type == TokenType::PARENTHESIS)
-    {
-        return 0;
-    }
-    else if (token.type == TokenType::UNARY_OPERATOR)
-    {    
-        return 16;
-    }
-    else if (precedence.find(token.value) != precedence.end())
+// Bits of the largest numerator or denominator in value
+static uint64_t resultBits(const Number &value)
+{
+    uint64_t bits = value.rationalPart.bits();
+    for (const Number::Term &term : value.terms)
     {
-        return precedence.at(token.value);
+        bits = std::max(bits, term.coeff.bits());
     }
-    return 0;
+    return bits;
 }
 
-Number evalUnaryOperator(const Number &operand, const std::string &op);
-Number evalBinaryOperator(Number &left, const Number &right, const std::string &op);
-Number evalArithmeticOperator(const Number &left, const Number &right, const std::string &op);
+// Chains shorter than this gain nothing from the accumulator
+static const uint32_t minChainLeaves = 8;
+
+enum class ChainKind : uint8_t
+{
+    NONE,
+    SUM,
+    PRODUCT
+};
 
-Number evalUnaryOperator(const Number &operand, const std::string &op)
+static ChainKind chainKind(const ASTNode &node)
 {
-    if (op == "-")
+    if (node.type != NodeType::BINARY)
     {
-        return -operand;
+        return ChainKind::NONE;
     }
-    else if (op == "+")
+    switch (node.op)
     {
-        return operand;
+    case OperatorKind::ADD:
+    case OperatorKind::SUB:
+        return ChainKind::SUM;
+    case OperatorKind::MUL:
+    case OperatorKind::DIV:
+        return ChainKind::PRODUCT;
+    default:
+        return ChainKind::NONE;
     }
-    throw std::runtime_error("Unsupported unary operator: " + op);
 }
 
-Number evalBinaryOperator(Number &left, const Number &right, const std::string &op)
+Number evalUnaryOperator(const Number &operand, OperatorKind op);
+Number evalBinaryOperator(const Number &left, const Number &right, OperatorKind op);
+
+Number evalUnaryOperator(const Number &operand, OperatorKind op)
 {
-    if (op == "=")
-    {
-        return left = right;
-    }
-    else if (op == "+=")
+    if (op == OperatorKind::ADD)
     {
-        return left = (left + right);
+        return operand;
     }
-    else if (op == "-=")
+    OpCode code = operatorInfo(op).unaryOp;
+    if (code == OpCode::NONE)
     {
-        return left = (left - right);
+        throw std::runtime_error("Unsupported unary operator: " + std::string(operatorInfo(op).symbol));
     }
-    else if (op == "*=")
+    return applyUnary(code, operand);
+}
+
+Number evalBinaryOperator(const Number &left, const Number &right, OperatorKind op)
+{
+    OpCode code = operatorInfo(op).binaryOp;
+    if (code == OpCode::NONE)
     {
-        return left = (left * right);
+        throw std::runtime_error("Unsupported binary operator: " + std::string(operatorInfo(op).symbol));
     }
-    else if (op == "/=")
+    return applyBinary(code, left, right);
+}
+
+uint32_t ASTArena::add(ASTNode node)
+{
+    if (m_Nodes.size() >= UINT32_MAX)
     {
-        return left = (left / right);
+        throw std::runtime_error("Expression too large");
     }
-    return evalArithmeticOperator(left, right, op);
+    m_Nodes.push_back(node);
+    return static_cast<uint32_t>(m_Nodes.size() - 1);
+}
+
+uint32_t ASTArena::addLiteral(Number value)
+{
+    m_Literals.push_back(std::move(value));
+    return add({NodeType::LITERAL, OperatorKind::NONE, static_cast<uint32_t>(m_Literals.size() - 1), 0});
 }
 
-Number evalArithmeticOperator(const Number &left, const Number &right, const std::string &op)
+uint32_t ASTArena::addVariable(uint32_t slot)
 {
-    if (op == "+")
+    return add({NodeType::VARIABLE, OperatorKind::NONE, slot, 0});
+}
+
+uint32_t ASTArena::addUnary(OperatorKind op, uint32_t operand)
+{
+    return add({NodeType::UNARY, op, operand, 0});
+}
+
+uint32_t ASTArena::addBinary(OperatorKind op, uint32_t lhs, uint32_t rhs)
+{
+    return add({NodeType::BINARY, op, lhs, rhs});
+}
+
+size_t ASTArena::memoryUsage() const
+{
+    return m_Nodes.capacity() * sizeof(ASTNode) + m_Literals.capacity() * sizeof(Number);
+}
+
+Number Expression::eval()
+{
+    parse();
+    return evaluate();
+}
+
+Number Expression::evaluate()
+{
+    if (m_AST.empty())
     {
-        return left + right;
+        throw std::runtime_error("Expression has not been parsed");
     }
-    else if (op == "-")
+
+    Metrics::ScopedTimer timer(Metric::EVAL_NS);
+    Environment &env = environment();
+
+    // Children always precede their parent in the arena, so a single forward
+    // sweep evaluates every node after its operands without recursing
+    m_Values.resize(m_AST.size());
+    if (!m_ChainsReady)
     {
-        return left - right;
+        m_HasChains = prepareChains();
+        m_ChainsReady = true;
     }
-    else if (op == "*")
+    const bool chains = m_HasChains;
+    for (uint32_t i = 0; i < m_AST.size(); ++i)
     {
-        return left * right;
+        checkCancelled();
+        const ASTNode &node = m_AST[i];
+        switch (node.type)
+        {
+        case NodeType::LITERAL:
+            m_Values[i] = m_AST.literal(node);
+            break;
+        case NodeType::VARIABLE:
+            m_Values[i] = env[node.lhs];
+            break;
+        case NodeType::UNARY:
+            m_Values[i] = evalUnaryOperator(m_Values[node.lhs], node.op);
+            break;
+        case NodeType::BINARY:
+            if (chains && m_ChainRoles[i] != ChainRole::NONE)
+            {
+                if (m_ChainRoles[i] == ChainRole::ROOT)
+                {
+                    m_Values[i] = evaluateChain(i);
+                }
+            }
+            else if (operatorInfo(node.op).assignment)
+            {
+                if (node.op == OperatorKind::ASSIGN)
+                {
+                    m_Values[i] = m_Values[node.rhs];
+                }
+                else
+                {
+                    m_Values[i] = evalBinaryOperator(m_Values[node.lhs], m_Values[node.rhs], node.op);
+                }
+                env[m_AST[node.lhs].lhs] = m_Values[i];
+            }
+            else
+            {
+                m_Values[i] = evalBinaryOperator(m_Values[node.lhs], m_Values[node.rhs], node.op);
+            }
+            break;
+        }
     }
-    else if (op == "/")
+    if (Metrics::enabled())
     {
-        return left / right;
+        Metrics::record(Metric::RESULT_BITS, resultBits(m_Values[m_AST.root()]));
     }
-    else if (op == "&&")
+    return m_Values[m_AST.root()];
+}
+
+bool Expression::prepareChains()
+{
+    // Most expressions have too few operators of one kind for a chain
+    const uint32_t size = m_AST.size();
+    if (size < 2 * minChainLeaves - 1)
     {
-        return left && right;
+        return false;
     }
-    else if (op == "||")
+    uint32_t sums = 0, products = 0;
+    for (uint32_t i = 0; i < size; ++i)
     {
-        return left || right;
+        ChainKind kind = chainKind(m_AST[i]);
+        sums += kind == ChainKind::SUM;
+        products += kind == ChainKind::PRODUCT;
     }
-    else if (op == "==")
+    if (sums < minChainLeaves - 1 && products < minChainLeaves - 1)
     {
-        return left == right;
+        return false;
+    }
+
+    m_Uses.assign(size, 0);
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        const ASTNode &node = m_AST[i];
+        if (node.type == NodeType::UNARY)
+        {
+            m_Uses[node.lhs]++;
+        }
+        else if (node.type == NodeType::BINARY)
+        {
+            m_Uses[node.lhs]++;
+            m_Uses[node.rhs]++;
+        }
     }
-    else if (op == "!=")
+    // Operators the optimizer shared keep their own value
+    auto continues = [&](ChainKind kind, uint32_t child) {
+        return chainKind(m_AST[child]) == kind && m_Uses[child] == 1;
+    };
+
+    m_ChainLeaves.assign(size, 0);
+    for (uint32_t i = 0; i < size; ++i)
     {
-        return left != right;
+        ChainKind kind = chainKind(m_AST[i]);
+        if (kind != ChainKind::NONE)
+        {
+            const ASTNode &node = m_AST[i];
+            m_ChainLeaves[i] = (continues(kind, node.lhs) ? m_ChainLeaves[node.lhs] : 1) +
+                               (continues(kind, node.rhs) ? m_ChainLeaves[node.rhs] : 1);
+        }
     }
-    else if (op == "<")
+
+    // Parents come after their children, so backwards every node is seen
+    // after the chain it belongs to
+    bool found = false;
+    m_ChainRoles.assign(size, ChainRole::NONE);
+    for (uint32_t i = size; i-- > 0;)
     {
-        return left < right;
+        ChainKind kind = chainKind(m_AST[i]);
+        if (kind == ChainKind::NONE)
+        {
+            continue;
+        }
+        if (m_ChainRoles[i] == ChainRole::NONE && m_ChainLeaves[i] >= minChainLeaves)
+        {
+            m_ChainRoles[i] = ChainRole::ROOT;
+            found = true;
+        }
+        if (m_ChainRoles[i] != ChainRole::NONE)
+        {
+            const ASTNode &node = m_AST[i];
+            if (continues(kind, node.lhs))
+            {
+                m_ChainRoles[node.lhs] = ChainRole::INTERIOR;
+            }
+            if (continues(kind, node.rhs))
+            {
+                m_ChainRoles[node.rhs] = ChainRole::INTERIOR;
+            }
+        }
     }
-    else if (op == "<=")
+    return found;
+}
+
+Number Expression::evaluateChain(uint32_t root)
+{
+    bool product = chainKind(m_AST[root]) == ChainKind::PRODUCT;
+    // Operands left to right, the right operand of - and / inverted
+    m_ChainOperands.clear();
+    m_ChainInterior.clear();
+    m_ChainStack.clear();
+    m_ChainStack.push_back({root, false});
+    bool exact = true;
+    while (!m_ChainStack.empty())
     {
-        return left <= right;
+        auto [index, inverted] = m_ChainStack.back();
+        m_ChainStack.pop_back();
+        if (index == root || m_ChainRoles[index] == ChainRole::INTERIOR)
+        {
+            const ASTNode &node = m_AST[index];
+            bool inverts = node.op == OperatorKind::SUB || node.op == OperatorKind::DIV;
+            m_ChainStack.push_back({node.rhs, inverted != inverts});
+            m_ChainStack.push_back({node.lhs, inverted});
+            if (index != root)
+            {
+                m_ChainInterior.push_back(index);
+            }
+        }
+        else
+        {
+            m_ChainOperands.push_back({index, inverted});
+            // Zero is left to the operators as well, a / (b / 0) must still
+            // fail after the chain is flattened to a / b * 0
+            const Number &value = m_Values[index];
+            exact = exact && value.isPureRational() && value.inexactBits == 0 && !(product && value.rationalPart.isZero());
+        }
     }
-    else if (op == ">")
+
+    if (!exact)
     {
-        return left > right;
+        // Symbolic operands keep the operators of Number, node by node
+        std::sort(m_ChainInterior.begin(), m_ChainInterior.end());
+        m_ChainInterior.push_back(root);
+        for (uint32_t index : m_ChainInterior)
+        {
+            const ASTNode &node = m_AST[index];
+            m_Values[index] = evalBinaryOperator(m_Values[node.lhs], m_Values[node.rhs], node.op);
+        }
+        return m_Values[root];
     }
-    else if (op == ">=")
+
+    // The leftmost operand is never inverted
+    RationalAccumulator accumulator(m_Values[m_ChainOperands.front().first].rationalPart);
+    for (size_t i = 1; i < m_ChainOperands.size(); ++i)
     {
-        return left >= right;
+        checkCancelled();
+        const Rational &value = m_Values[m_ChainOperands[i].first].rationalPart;
+        bool inverted = m_ChainOperands[i].second;
+        if (product)
+        {
+            inverted ? accumulator.divide(value) : accumulator.multiply(value);
+        }
+        else
+        {
+            inverted ? accumulator.subtract(value) : accumulator.add(value);
+        }
     }
-    throw std::runtime_error("Unsupported binary operator: " + op);
+    return Number(accumulator.result());
 }
 
-BinaryOpNode::BinaryOpNode(std::string op, std::unique_ptr<ASTNode> lhs, std::unique_ptr<ASTNode> rhs)
-    : op(std::move(op)), left(std::move(lhs)), right(std::move(rhs)) {}
-
-Number BinaryOpNode::evaluate()
+const OptimizerStats &Expression::optimize()
 {
-    Number lhsVal = left->evaluate();
-    Number rhsVal = right->evaluate();
-
-    return evalBinaryOperator(lhsVal, rhsVal, op);
+    m_OptimizerStats = Optimizer::run(m_AST);
+    m_ChainsReady = false;
+    return m_OptimizerStats;
 }
 
-UnaryOpNode::UnaryOpNode(std::string op, std::unique_ptr<ASTNode> operand)
-    : op(std::move(op)), operand(std::move(operand)) {}
-
-Number UnaryOpNode::evaluate()
+CompiledExpression Expression::compile()
 {
-    Number value = operand->evaluate();
+    parse();
+    optimize();
+    CompiledExpression out;
+    out.bind(&environment());
+
+    // The optimizer may share subtrees. Operators read more than once are
+    // computed on first use, kept in a temporary and reloaded afterwards.
+    std::vector<uint32_t> uses(m_AST.size(), 0);
+    for (uint32_t i = 0; i < m_AST.size(); ++i)
+    {
+        const ASTNode &node = m_AST[i];
+        if (node.type == NodeType::UNARY)
+        {
+            uses[node.lhs]++;
+        }
+        else if (node.type == NodeType::BINARY)
+        {
+            if (node.op != OperatorKind::ASSIGN)
+            {
+                uses[node.lhs]++;
+            }
+            uses[node.rhs]++;
+        }
+    }
+    std::vector<uint32_t> temps(m_AST.size(), UINT32_MAX);
+    uint32_t tempCount = 0;
+    auto finish = [&](uint32_t index) {
+        if (uses[index] > 1)
+        {
+            temps[index] = tempCount++;
+            out.emit(OpCode::STORE_TEMP, temps[index]);
+        }
+    };
 
-    return evalUnaryOperator(value, op);
-}
+    // Iterative post-order walk, long operator chains are as deep as they are
+    // long and would overflow the call stack if this recursed
+    struct Frame
+    {
+        uint32_t node;
+        uint8_t state; // number of children already emitted
+    };
+    std::vector<Frame> stack;
+    stack.push_back({m_AST.root(), 0});
 
-LiteralNode::LiteralNode(Number val) : value(std::move(val)) {}
+    while (!stack.empty())
+    {
+        Frame frame = stack.back();
+        const ASTNode &node = m_AST[frame.node];
 
-LiteralNode::LiteralNode(std::string val)
-{
-    value = Number(val);
+        if (node.type == NodeType::LITERAL)
+        {
+            out.emitConstant(m_AST.literal(node));
+            stack.pop_back();
+        }
+        else if (node.type == NodeType::VARIABLE)
+        {
+            out.emit(OpCode::LOAD_VAR, node.lhs);
+            stack.pop_back();
+        }
+        else if (temps[frame.node] != UINT32_MAX)
+        {
+            out.emit(OpCode::LOAD_TEMP, temps[frame.node]);
+            stack.pop_back();
+        }
+        else if (node.type == NodeType::UNARY)
+        {
+            if (frame.state == 0)
+            {
+                stack.back().state = 1;
+                stack.push_back({node.lhs, 0});
+                continue;
+            }
+            if (node.op != OperatorKind::ADD)
+            {
+                OpCode code = operatorInfo(node.op).unaryOp;
+                if (code == OpCode::NONE)
+                {
+                    throw std::runtime_error("Unsupported unary operator: " + std::string(operatorInfo(node.op).symbol));
+                }
+                out.emit(code);
+            }
+            finish(frame.node);
+            stack.pop_back();
+        }
+        else if (frame.state == 0)
+        {
+            // A plain assignment does not read its target
+            stack.back().state = 1;
+            if (node.op != OperatorKind::ASSIGN)
+            {
+                stack.push_back({node.lhs, 0});
+            }
+        }
+        else if (frame.state == 1)
+        {
+            stack.back().state = 2;
+            stack.push_back({node.rhs, 0});
+        }
+        else
+        {
+            const OperatorInfo &info = operatorInfo(node.op);
+            if (node.op != OperatorKind::ASSIGN)
+            {
+                if (info.binaryOp == OpCode::NONE)
+                {
+                    throw std::runtime_error("Unsupported binary operator: " + std::string(info.symbol));
+                }
+                out.emit(info.binaryOp);
+            }
+            if (info.assignment)
+            {
+                out.emit(OpCode::STORE_VAR, m_AST[node.lhs].lhs);
+            }
+            finish(frame.node);
+            stack.pop_back();
+        }
+    }
+    return out;
 }
 
-Number LiteralNode::evaluate()
+void Expression::pushToken(TokenType type, size_t begin, size_t end, OperatorKind op)
 {
-    return value;
+    Token token;
+    token.type = type;
+    token.op = op;
+    token.offset = static_cast<uint32_t>(begin);
+    token.length = static_cast<uint32_t>(end - begin);
+    if (type == TokenType::UNARY_OPERATOR)
+    {
+        token.precedence = unaryPrecedence;
+    }
+    else if (type == TokenType::OPERATOR)
+    {
+        token.precedence = operatorInfo(op).precedence;
+    }
+    else
+    {
+        token.precedence = 0;
+    }
+    m_Tokens.push_back(token);
 }
 
-Number Expression::eval()
+void Expression::tokenize(size_t from)
 {
-    m_Tokens.clear();
-    tokenize();
-    index = 0;
-    parse();
-    return m_ASThead->evaluate();
-}
+    if (m_expr.size() > UINT32_MAX)
+    {
+        throw std::runtime_error("Expression too long");
+    }
 
-void Expression::tokenize()
-{
-    std::vector<std::string> rawTokens;
-    std::string token;
-    uint64_t i = 0;
+    const std::string_view expr(m_expr);
+    const size_t size = expr.size();
+    size_t i = from;
 
-    static const std::set<std::string> multiCharOperators = {
-        "==", "!=", "<=", ">=", "&&", "||", "->", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<", ">>"
-    };
+    auto isDigit = [](char ch) { return std::isdigit(static_cast<unsigned char>(ch)) != 0; };
 
-    // First Pass: Raw token extraction
-    while (i < m_expr.size())
+    while (i < size)
     {
-        char c = m_expr[i];
+        checkCancelled();
+        char c = expr[i];
+        size_t begin = i;
 
-        if (std::isspace(c))
+        if (std::isspace(static_cast<unsigned char>(c)))
         {
             i++;
             continue;
@@ -220,51 +547,42 @@ void Expression::tokenize()
         if (c == '"' || c == '\'')
         {
             char quote = c;
-            token.clear();
-            token += quote;
             i++;
-            while (i < m_expr.size())
+            while (i < size)
             {
-                char ch = m_expr[i];
-                token += ch;
-                i++;
-                if (ch == '\\' && i < m_expr.size())  // Escape character
+                char ch = expr[i++];
+                if (ch == '\\' && i < size) // Escape character
                 {
-                    token += m_expr[i];
                     i++;
                     continue;
                 }
                 if (ch == quote)
                     break;
             }
-            rawTokens.push_back(token);
+            pushToken(TokenType::STRING_LITERAL, begin, i);
             continue;
         }
 
         // --- FLOATING POINT OR INTEGER NUMBERS ---
-        if (std::isdigit(c) || (c == '.' && i + 1 < m_expr.size() && std::isdigit(m_expr[i + 1])) || 
-            (c == '0' && i + 1 < m_expr.size() && (m_expr[i + 1] == 'x' || m_expr[i + 1] == 'X' || m_expr[i + 1] == 'b' || m_expr[i + 1] == 'B')))
+        if (isDigit(c) || (c == '.' && i + 1 < size && isDigit(expr[i + 1])))
         {
-            token.clear();
-
-            if (m_expr[i] == '0' && i + 1 < m_expr.size() && (m_expr[i + 1] == 'x' || m_expr[i + 1] == 'X'))
+            char prefix = i + 1 < size ? expr[i + 1] : '\0';
+            if (c == '0' && (prefix == 'x' || prefix == 'X'))
             {
                 // Hex literal: 0x...
-                token += m_expr[i++];
-                token += m_expr[i++];
-                while (i < m_expr.size() && std::isxdigit(m_expr[i]))
+                i += 2;
+                while (i < size && std::isxdigit(static_cast<unsigned char>(expr[i])))
                 {
-                    token += m_expr[i++];
+                    i++;
                 }
             }
-            else if (m_expr[i] == '0' && i + 1 < m_expr.size() && (m_expr[i + 1] == 'b' || m_expr[i + 1] == 'B'))
+            else if (c == '0' && (prefix == 'b' || prefix == 'B'))
             {
                 // Binary literal: 0b...
-                token += m_expr[i++];
-                token += m_expr[i++];
-                while (i < m_expr.size() && (m_expr[i] == '0' || m_expr[i] == '1'))
+                i += 2;
+                while (i < size && (expr[i] == '0' || expr[i] == '1'))
                 {
-                    token += m_expr[i++];
+                    i++;
                 }
             }
             else
@@ -272,28 +590,25 @@ void Expression::tokenize()
                 // Decimal or floating point
                 bool hasDot = false;
                 bool hasExp = false;
-                while (i < m_expr.size())
+                while (i < size)
                 {
-                    char ch = m_expr[i];
-                    if (std::isdigit(ch))
+                    char ch = expr[i];
+                    if (isDigit(ch))
                     {
-                        token += ch;
                         i++;
                     }
                     else if (ch == '.' && !hasDot)
                     {
                         hasDot = true;
-                        token += ch;
                         i++;
                     }
                     else if ((ch == 'e' || ch == 'E') && !hasExp)
                     {
                         hasExp = true;
-                        token += ch;
                         i++;
-                        if (i < m_expr.size() && (m_expr[i] == '+' || m_expr[i] == '-'))
+                        if (i < size && (expr[i] == '+' || expr[i] == '-'))
                         {
-                            token += m_expr[i++];
+                            i++;
                         }
                     }
                     else
@@ -303,95 +618,61 @@ void Expression::tokenize()
                 }
 
                 // Optional float suffix (f/F, l/L)
-                if (i < m_expr.size() && (m_expr[i] == 'f' || m_expr[i] == 'F' || m_expr[i] == 'l' || m_expr[i] == 'L'))
+                if (i < size && (expr[i] == 'f' || expr[i] == 'F' || expr[i] == 'l' || expr[i] == 'L'))
                 {
-                    token += m_expr[i++];
+                    i++;
                 }
             }
 
             // Optional integer suffix (u/U, l/L, ul/UL, etc.)
-            while (i < m_expr.size() && (m_expr[i] == 'u' || m_expr[i] == 'U' || m_expr[i] == 'l' || m_expr[i] == 'L'))
+            while (i < size && (expr[i] == 'u' || expr[i] == 'U' || expr[i] == 'l' || expr[i] == 'L'))
             {
-                token += m_expr[i++];
+                i++;
             }
 
-            rawTokens.push_back(token);
+            pushToken(TokenType::NUMBER, begin, i);
             continue;
         }
 
         // --- SYMBOLS (identifiers) ---
-        if (std::isalpha(c) || c == '_')
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
         {
-            token.clear();
-            while (i < m_expr.size() && (std::isalnum(m_expr[i]) || m_expr[i] == '_'))
+            while (i < size && (std::isalnum(static_cast<unsigned char>(expr[i])) || expr[i] == '_'))
             {
-                token += m_expr[i];
                 i++;
             }
-            rawTokens.push_back(token);
+            pushToken(TokenType::IDENTIFIER, begin, i);
             continue;
         }
 
-        // --- MULTI-CHARACTER OPERATORS ---
-        bool matched = false;
-        for (int len = 3; len >= 2; --len)
-        {
-            if (i + len <= m_expr.size())
-            {
-                std::string op = m_expr.substr(i, len);
-                if (multiCharOperators.count(op))
-                {
-                    rawTokens.push_back(op);
-                    i += len;
-                    matched = true;
-                    break;
-                }
-            }
-        }
-        if (matched) continue;
-
-        // --- SINGLE CHARACTER TOKEN ---
-        rawTokens.push_back(std::string(1, m_expr[i]));
-        i++;
-    }
-
-    // Second Pass: Type assignment
-    for (size_t j = 0; j < rawTokens.size(); ++j)
-    {
-        const std::string &tok = rawTokens[j];
-        TokenType type;
+        // --- OPERATORS AND PARENTHESES ---
+        OperatorKind op;
+        i += matchOperator(expr, i, op);
 
-        if (tok == "(" || tok == ")")
+        if (op == OperatorKind::LEFT_PAREN || op == OperatorKind::RIGHT_PAREN)
         {
-            type = TokenType::PARENTHESIS;
-        }
-        else if ((tok.front() == '"' && tok.back() == '"') || (tok.front() == '\'' && tok.back() == '\''))
-        {
-            type = TokenType::STRING_LITERAL;
-        }
-        else if (std::isdigit(tok[0]) || tok[0] == '.')
-        {
-            type = TokenType::NUMBER;
+            pushToken(TokenType::PARENTHESIS, begin, i, op);
+            continue;
         }
-        else if (tok == "+" || tok == "-" || tok == "*" || tok == "&" || tok == "=")
+
+        // A prefix operator is one that does not follow an operand
+        bool afterOperand = !m_Tokens.empty() &&
+                            (m_Tokens.back().type == TokenType::NUMBER ||
+                             m_Tokens.back().type == TokenType::IDENTIFIER ||
+                             m_Tokens.back().type == TokenType::STRING_LITERAL ||
+                             m_Tokens.back().op == OperatorKind::RIGHT_PAREN);
+        if (!afterOperand && (operatorInfo(op).arity & ARITY_UNARY))
         {
-            if (m_Tokens.empty() || (m_Tokens.back().type != TokenType::NUMBER &&
-                                m_Tokens.back().type != TokenType::PARENTHESIS &&
-                                m_Tokens.back().value != ")"))
-                type = TokenType::UNARY_OPERATOR;
-            else
-                type = TokenType::OPERATOR;
+            pushToken(TokenType::UNARY_OPERATOR, begin, i, op);
         }
         else
         {
-            type = TokenType::OPERATOR;
+            pushToken(TokenType::OPERATOR, begin, i, op);
         }
-
-        m_Tokens.push_back({type, tok});
     }
 }
 
-std::unique_ptr<ASTNode> Expression::parsePrimary()
+uint32_t Expression::parsePrimary()
 {
     if (index >= m_Tokens.size())
         throw std::runtime_error("Unexpected end of input, index: " + std::to_string(index));
@@ -399,32 +680,65 @@ std::unique_ptr<ASTNode> Expression::parsePrimary()
     Token token = m_Tokens[index++];
     if (token.type == TokenType::NUMBER)
     {
-        return std::make_unique<LiteralNode>(token.value);
+        std::string_view literal = text(token);
+        const char *last = literal.data() + literal.size();
+        Rational value;
+        std::from_chars_result result = NumberLiteral::parse(literal.data(), last, value);
+        if (result.ec != std::errc() || result.ptr != last)
+        {
+            throw std::runtime_error((result.ec == std::errc::result_out_of_range ? "Number out of range: " : "Invalid number: ") +
+                                    std::string(literal));
+        }
+        return m_AST.addLiteral(Number(std::move(value)));
+    }
+    else if (token.type == TokenType::IDENTIFIER)
+    {
+        std::string_view name = text(token);
+        if (name == "pi")
+        {
+            return m_AST.addLiteral(Number::pi());
+        }
+        else if (name == "e")
+        {
+            return m_AST.addLiteral(Number::e());
+        }
+
+        // Only a plain assignment may introduce a new variable. Its slot is
+        // created once the right side has parsed, see parseExpression(), so
+        // x = x + 1 still finds x undefined and a failed parse adds nothing.
+        uint32_t slot = environment().find(name);
+        bool assigned = index < m_Tokens.size() && m_Tokens[index].type == TokenType::OPERATOR &&
+                        m_Tokens[index].op == OperatorKind::ASSIGN;
+        if (slot == Environment::npos && !assigned)
+        {
+            throw std::runtime_error("Undefined variable: " + std::string(name));
+        }
+        return m_AST.addVariable(slot);
     }
-    else if (token.type == TokenType::PARENTHESIS && token.value == "(")
+    else if (token.op == OperatorKind::LEFT_PAREN)
     {
-        auto expr = parseExpression(1);
-        if (index >= m_Tokens.size() || (m_Tokens[index].type != TokenType::PARENTHESIS && m_Tokens[index].value != ")"))
+        uint32_t expr = parseExpression(1);
+        if (index >= m_Tokens.size() || m_Tokens[index].op != OperatorKind::RIGHT_PAREN)
         {
             if (index >= m_Tokens.size())
             {
                 throw std::runtime_error("Expected closing parenthesis, index: " + std::to_string(index));
             }
-            throw std::runtime_error("Expected closing parenthesis: " + m_Tokens[index].value + ", index: " + std::to_string(index));
+            throw std::runtime_error("Expected closing parenthesis: " + std::string(text(m_Tokens[index])) + ", index: " + std::to_string(index));
         }
         ++index;
         return expr;
     }
-    throw std::runtime_error("Unexpected token in primary expression: " + m_Tokens[index].value + ", index: " + std::to_string(index));
+    throw std::runtime_error("Unexpected token in primary expression: " + std::string(text(token)) + ", index: " + std::to_string(index - 1));
 }
 
-std::unique_ptr<ASTNode> Expression::parseExpression(int minPrecedence)
+uint32_t Expression::parseExpression(int minPrecedence)
 {
     if (minPrecedence == 0)
     {
         minPrecedence = 1;
     }
-    std::unique_ptr<ASTNode> lhs;
+    uint32_t lhs;
 
     if (index >= m_Tokens.size())
         throw std::runtime_error("Unexpected end of input");
@@ -433,21 +747,35 @@ std::unique_ptr<ASTNode> Expression::parseExpression(int minPrecedence)
     if (token.type == TokenType::UNARY_OPERATOR)
     {
         index++; // Consume the operator
-        auto operand = parseExpression(getPrecedence(token) + 1);
-        lhs = std::make_unique<UnaryOpNode>(token.value, std::move(operand));
+        uint32_t operand = parseExpression(getPrecedence(token) + 1);
+        lhs = m_AST.addUnary(token.op, operand);
     }
     else
     {
         lhs = parsePrimary();
     }
+    const size_t first = index - 1; // the token of lhs when it is a variable
 
     // Handle binary operators
     while (index < m_Tokens.size() && getPrecedence(m_Tokens[index]) >= minPrecedence)
     {
+        checkCancelled();
         Token opToken = m_Tokens[index++];
         int precedence = getPrecedence(opToken);
-        auto rhs = parseExpression(precedence + 1);
-        lhs = std::make_unique<BinaryOpNode>(opToken.value, std::move(lhs), std::move(rhs));
+        if (operatorInfo(opToken.op).associativity == Associativity::LEFT)
+        {
+            precedence++;
+        }
+        uint32_t rhs = parseExpression(precedence);
+        if (operatorInfo(opToken.op).assignment && m_AST[lhs].type != NodeType::VARIABLE)
+        {
+            throw std::runtime_error("Left side of " + std::string(text(opToken)) + " must be a variable");
+        }
+        if (opToken.op == OperatorKind::ASSIGN && m_AST[lhs].lhs == Environment::npos)
+        {
+            m_AST.setSlot(lhs, environment().slot(text(m_Tokens[first])));
+        }
+        lhs = m_AST.addBinary(opToken.op, lhs, rhs);
     }
 
     return lhs;
@@ -455,6 +783,53 @@ std::unique_ptr<ASTNode> Expression::parseExpression(int minPrecedence)
 
 void Expression::parse()
 {
+    m_Tokens.clear();
+    {
+        Metrics::ScopedTimer timer(Metric::LEX_NS);
+        tokenize(0);
+    }
+    parseTokens();
+}
+
+void Expression::update(std::string expr)
+{
+    size_t prefix = std::mismatch(m_expr.begin(), m_expr.begin() + std::min(m_expr.size(), expr.size()),
+                                  expr.begin())
+                        .first -
+                    m_expr.begin();
+    m_expr = std::move(expr);
+
+    // The lexer decides where a token ends by looking at the character after
+    // it, so only tokens ending before the first edited character are kept
+    size_t keep = 0;
+    while (keep < m_Tokens.size() && m_Tokens[keep].offset + m_Tokens[keep].length < prefix)
+    {
+        keep++;
+    }
+    m_Tokens.resize(keep);
+    {
+        Metrics::ScopedTimer timer(Metric::LEX_NS);
+        tokenize(keep ? m_Tokens.back().offset + m_Tokens.back().length : 0);
+    }
+    parseTokens();
+}
+
+void Expression::parseTokens()
+{
+    Metrics::ScopedTimer timer(Metric::PARSE_NS);
+    Metrics::record(Metric::TOKENS, m_Tokens.size());
+    m_AST.clear();
+    m_ChainsReady = false;
+
+    // Every node comes from at least one token, so this is an upper bound
+    size_t literals = 0;
+    for (const Token &token : m_Tokens)
+    {
+        literals += token.type == TokenType::NUMBER;
+    }
+    m_AST.reserve(m_Tokens.size(), literals);
+
     index = 0;
-    m_ASThead = parseExpression(1);
-}
\ No newline at end of file
+    parseExpression(1);
+    Metrics::record(Metric::NODES, m_AST.size());
+}
@@ -33,67 +33,119 @@
 #define _EXPRESSION_H_
 
 #include <string>
-#include <memory>
 #include <vector>
+#include <string_view>
+#include <cstdint>
 #include <stdexcept>
+#include <atomic>
 #include "Number.h"
+#include "Operators.h"
+#include "Environment.h"
+#include "CompiledExpression.h"
+#include "Optimizer.h"
 
-class ASTNode
+enum class TokenType
 {
-public:
-    virtual ~ASTNode() = default;
-    virtual Number evaluate() = 0;
+    NUMBER,
+    OPERATOR,
+    UNARY_OPERATOR,
+    PARENTHESIS,
+    ASSIGNMENT,
+    FUNCTION_CALL,
+    STRING_LITERAL,
+    IDENTIFIER
 };
 
-class BinaryOpNode : public ASTNode
+// A token refers to its text by offset into the expression string, so lexing
+// does not allocate per token
+struct Token
 {
-public:
-    std::string op;
-    std::unique_ptr<ASTNode> left, right;
-
-    BinaryOpNode(std::string op, std::unique_ptr<ASTNode> lhs, std::unique_ptr<ASTNode> rhs);
-
-    Number evaluate() override;
+    TokenType type;
+    OperatorKind op;
+    uint8_t precedence;
+    uint32_t offset;
+    uint32_t length;
 };
 
-class UnaryOpNode : public ASTNode
+enum class NodeType : uint8_t
 {
-public:
-    std::string op;
-    std::unique_ptr<ASTNode> operand;
-
-    UnaryOpNode(std::string op, std::unique_ptr<ASTNode> operand);
+    LITERAL,
+    VARIABLE,
+    UNARY,
+    BINARY
+};
 
-    Number evaluate() override;
+// Nodes refer to their children by index into the arena they live in
+struct ASTNode
+{
+    NodeType type;
+    OperatorKind op;
+    uint32_t lhs; // operand of a UNARY node, literal index of a LITERAL node,
+                  // environment slot of a VARIABLE node
+    uint32_t rhs;
 };
 
-class LiteralNode : public ASTNode
+// Contiguous storage for the AST of one expression. Nodes are appended after
+// their children, so the arena is in post-order and the root is the last node.
+// clear() releases the whole tree at once.
+class ASTArena
 {
 public:
-    Number value;
+    uint32_t addLiteral(Number value);
+    uint32_t addVariable(uint32_t slot);
+    uint32_t addUnary(OperatorKind op, uint32_t operand);
+    uint32_t addBinary(OperatorKind op, uint32_t lhs, uint32_t rhs);
 
-    LiteralNode(Number val);
-    LiteralNode(std::string val);
+    void reserve(size_t nodes, size_t literals)
+    {
+        m_Nodes.reserve(nodes);
+        m_Literals.reserve(literals);
+    }
+    void clear()
+    {
+        m_Nodes.clear();
+        m_Literals.clear();
+    }
+    bool empty() const
+    {
+        return m_Nodes.empty();
+    }
+    uint32_t size() const
+    {
+        return static_cast<uint32_t>(m_Nodes.size());
+    }
+    uint32_t root() const
+    {
+        return size() - 1;
+    }
+    const ASTNode &operator[](uint32_t index) const
+    {
+        return m_Nodes[index];
+    }
+    const Number &literal(const ASTNode &node) const
+    {
+        return m_Literals[node.lhs];
+    }
+    // Points the VARIABLE node at index to slot
+    void setSlot(uint32_t index, uint32_t slot)
+    {
+        m_Nodes[index].lhs = slot;
+    }
 
-    Number evaluate() override;
-};
+    // Bytes held by the node and literal storage
+    size_t memoryUsage() const;
 
+private:
+    uint32_t add(ASTNode node);
 
-enum class TokenType
-{
-    NUMBER,
-    OPERATOR,
-    UNARY_OPERATOR,
-    PARENTHESIS,
-    ASSIGNMENT,
-    FUNCTION_CALL,
-    STRING_LITERAL
+    std::vector<ASTNode> m_Nodes;
+    std::vector<Number> m_Literals;
 };
 
-struct Token
+class EvaluationCancelled : public std::runtime_error
 {
-    TokenType type;
-    std::string value;
+public:
+    EvaluationCancelled() : std::runtime_error("Evaluation cancelled") {}
 };
 
 class Expression
@@ -101,24 +153,133 @@ class Expression
 public:
     Expression() {}
     Expression(std::string expr) : m_expr(expr) {}
+    Expression(std::string expr, Environment &env) : m_expr(expr), m_Env(&env) {}
 
     void set(std::string expr)
     {
         m_expr = expr;
+        m_Tokens.clear();
+    }
+
+    // Variables are resolved against env when parsing. Without one the
+    // expression uses its own environment, which only lives as long as it does.
+    void setEnvironment(Environment &env)
+    {
+        m_Env = &env;
+    }
+    Environment &environment()
+    {
+        return m_Env ? *m_Env : m_LocalEnv;
     }
 
     Number eval();
-    
-private:
-    void tokenize();
+
+    // eval() split in its phases: parse() builds the AST, evaluate() walks
+    // the AST built by the last parse(). Neither runs the Optimizer: folding
+    // does the same arithmetic evaluate() would, node by node and without the
+    // chain accumulation, so it only pays off for code evaluated many times.
     void parse();
-    std::unique_ptr<ASTNode> parsePrimary();
-    std::unique_ptr<ASTNode> parseExpression(int minPrecedence);
+    Number evaluate();
+
+    // Only the lexing step of parse(), fills tokens()
+    void lex()
+    {
+        m_Tokens.clear();
+        tokenize(0);
+    }
+
+    // Replaces the text and parses it, re-lexing only from the first
+    // character that differs from the previous text
+    void update(std::string expr);
+
+    // parse(), update() and evaluate() throw EvaluationCancelled once flag is
+    // set. It is checked between tokens and nodes, a single big rational
+    // operation is not interrupted.
+    void setCancelFlag(const std::atomic<bool> *flag)
+    {
+        m_Cancel = flag;
+    }
+
+    // Rewrites the AST built by the last parse() with the Optimizer passes,
+    // evaluate() works on the result as well. compile() calls it, so
+    // CompiledExpression, BatchEvaluator and JitExpression are optimized.
+    const OptimizerStats &optimize();
+    const OptimizerStats &optimizerStats() const
+    {
+        return m_OptimizerStats;
+    }
+
+    // Parses, optimizes and lowers the expression to bytecode, so it can be
+    // evaluated repeatedly without walking the AST. The result is bound to
+    // environment().
+    CompiledExpression compile();
+
+    const std::vector<Token> &tokens() const
+    {
+        return m_Tokens;
+    }
+    std::string_view text(const Token &token) const
+    {
+        return std::string_view(m_expr).substr(token.offset, token.length);
+    }
+    const ASTArena &ast() const
+    {
+        return m_AST;
+    }
+    // Adopts an AST built by an earlier parse() of the same text, in place
+    // of parsing again. Its variable nodes must refer to environment().
+    void setAST(ASTArena ast)
+    {
+        m_AST = std::move(ast);
+        m_ChainsReady = false;
+        m_Tokens.clear();
+    }
+
+private:
+    // Lexes from offset from on, appending to m_Tokens
+    void tokenize(size_t from);
+    void parseTokens();
+    void checkCancelled() const
+    {
+        if (m_Cancel && m_Cancel->load(std::memory_order_relaxed))
+        {
+            throw EvaluationCancelled();
+        }
+    }
+    void pushToken(TokenType type, size_t begin, size_t end, OperatorKind op = OperatorKind::NONE);
+    uint32_t parsePrimary();
+    uint32_t parseExpression(int minPrecedence);
+
+    // Chains of + and - or of * and / with many operands are evaluated at
+    // their root with a RationalAccumulator, instead of node by node
+    enum class ChainRole : uint8_t
+    {
+        NONE,
+        ROOT,
+        INTERIOR // evaluated by the root of its chain
+    };
+    // Fills m_ChainRoles, false when the AST has no long chain. Done once
+    // per AST, parsing and optimizing reset m_ChainsReady.
+    bool prepareChains();
+    Number evaluateChain(uint32_t root);
 
 private:
     std::string m_expr;
-    std::unique_ptr<ASTNode> m_ASThead;
+    Environment *m_Env = nullptr;
+    Environment m_LocalEnv;
+    ASTArena m_AST;
+    std::vector<Number> m_Values; // per-node results, reused by evaluate()
+    bool m_ChainsReady = false;
+    bool m_HasChains = false;
+    std::vector<ChainRole> m_ChainRoles;
+    std::vector<uint32_t> m_Uses;
+    std::vector<uint32_t> m_ChainLeaves;
+    std::vector<std::pair<uint32_t, bool>> m_ChainStack;    // node, subtracted or divided
+    std::vector<std::pair<uint32_t, bool>> m_ChainOperands;
+    std::vector<uint32_t> m_ChainInterior;
     std::vector<Token> m_Tokens;
+    OptimizerStats m_OptimizerStats;
+    const std::atomic<bool> *m_Cancel = nullptr;
     size_t index; // index in m_Tokens
 };
 
@@ -0,0 +1,147 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           ExpressionCache.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    LRU cache of parsed expressions and their results
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "ExpressionCache.h"
+#include "Metrics.h"
+#include "NumberFormat.h"
+
+namespace
+{
+    size_t astMemoryUsage(const ASTArena &ast)
+    {
+        size_t bytes = ast.memoryUsage();
+        for (uint32_t i = 0; i < ast.size(); ++i)
+        {
+            if (ast[i].type == NodeType::LITERAL)
+            {
+                bytes += ExpressionCache::memoryUsage(ast.literal(ast[i])) - sizeof(Number);
+            }
+        }
+        return bytes;
+    }
+
+    bool readsVariables(const ASTArena &ast)
+    {
+        for (uint32_t i = 0; i < ast.size(); ++i)
+        {
+            if (ast[i].type == NodeType::VARIABLE)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+std::string ExpressionCache::normalize(const Expression &exp)
+{
+    std::string out;
+    for (const Token &token : exp.tokens())
+    {
+        if (!out.empty())
+        {
+            out.push_back(' ');
+        }
+        out += exp.text(token);
+    }
+    return out;
+}
+
+size_t ExpressionCache::memoryUsage(const Number &value)
+{
+    size_t bytes = sizeof(Number) + value.rationalPart.memoryUsage() + value.terms.capacity() * sizeof(Number::Term);
+    for (const Number::Term &term : value.terms)
+    {
+        bytes += term.coeff.memoryUsage();
+    }
+    return bytes;
+}
+
+ExpressionCache::Result ExpressionCache::eval(std::string_view expr)
+{
+    // The lexer is kept to reuse its token buffer, hits do not parse
+    m_Lexer.set(std::string(expr));
+    m_Lexer.setCancelFlag(m_Cancel);
+    m_Lexer.lex();
+    std::string key = normalize(m_Lexer);
+    if (Number::precision() != m_Precision || Number::maxTerms() != m_MaxTerms)
+    {
+        // The results were rounded under the old settings, the ASTs still hold
+        m_Results.clear();
+        m_Precision = Number::precision();
+        m_MaxTerms = Number::maxTerms();
+    }
+    if (const Result *result = m_Results.get(key))
+    {
+        return *result;
+    }
+
+    // Always the caller's text, the key is only for lookups
+    Expression exp{std::string(expr)};
+    exp.setCancelFlag(m_Cancel);
+    if (m_Env)
+    {
+        exp.setEnvironment(*m_Env);
+    }
+    bool cached = false;
+    if (const ASTArena *ast = m_ASTs.get(key))
+    {
+        exp.setAST(*ast);
+        cached = true;
+    }
+    else
+    {
+        exp.parse();
+    }
+
+    Result result;
+    result.value = exp.evaluate();
+    if (m_Cancel && m_Cancel->load(std::memory_order_relaxed))
+    {
+        // Formatting a huge result can take as long as computing it
+        throw EvaluationCancelled();
+    }
+    {
+        Metrics::ScopedTimer timer(Metric::FORMAT_NS);
+        result.text = NumberFormat::number(result.value);
+    }
+
+    if (readsVariables(exp.ast()))
+    {
+        return result;
+    }
+    if (!cached)
+    {
+        m_ASTs.put(key, exp.ast(), astMemoryUsage(exp.ast()));
+    }
+    size_t bytes = memoryUsage(result.value) + result.text.capacity();
+    m_Results.put(std::move(key), result, bytes);
+    return result;
+}
@@ -0,0 +1,225 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           ExpressionCache.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    LRU cache of parsed expressions and their results
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _EXPRESSION_CACHE_H_
+#define _EXPRESSION_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "Expression.h"
+
+struct CacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t memoryUsage = 0; // estimated bytes held by the entries
+};
+
+// Least recently used map from string keys to values, bounded by the
+// estimated memory of its entries rather than their count
+template <typename T>
+class LRUCache
+{
+public:
+    explicit LRUCache(size_t memoryLimit) : m_MemoryLimit(memoryLimit) {}
+
+    // Returns nullptr on a miss. The pointer is valid until the next put().
+    const T *get(std::string_view key)
+    {
+        auto it = m_Index.find(key);
+        if (it == m_Index.end())
+        {
+            m_Stats.misses++;
+            return nullptr;
+        }
+        m_Stats.hits++;
+        m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+        return &it->second->value;
+    }
+
+    // Entries larger than the whole limit are not stored
+    void put(std::string key, T value, size_t bytes)
+    {
+        bytes += key.size() + sizeof(Entry);
+        auto it = m_Index.find(key);
+        if (it != m_Index.end())
+        {
+            remove(it->second);
+        }
+        if (bytes > m_MemoryLimit)
+        {
+            return;
+        }
+        m_Entries.push_front({std::move(key), std::move(value), bytes});
+        m_Index.emplace(m_Entries.front().key, m_Entries.begin());
+        m_Stats.memoryUsage += bytes;
+        m_Stats.entries++;
+        shrink();
+    }
+
+    void setMemoryLimit(size_t memoryLimit)
+    {
+        m_MemoryLimit = memoryLimit;
+        shrink();
+    }
+    size_t memoryLimit() const
+    {
+        return m_MemoryLimit;
+    }
+
+    void clear()
+    {
+        m_Index.clear();
+        m_Entries.clear();
+        m_Stats.entries = 0;
+        m_Stats.memoryUsage = 0;
+    }
+
+    const CacheStats &stats() const
+    {
+        return m_Stats;
+    }
+
+private:
+    struct Entry
+    {
+        std::string key;
+        T value;
+        size_t bytes;
+    };
+    using Iterator = typename std::list<Entry>::iterator;
+
+    void remove(Iterator entry)
+    {
+        m_Stats.memoryUsage -= entry->bytes;
+        m_Stats.entries--;
+        m_Index.erase(entry->key);
+        m_Entries.erase(entry);
+    }
+
+    void shrink()
+    {
+        while (m_Stats.memoryUsage > m_MemoryLimit)
+        {
+            remove(std::prev(m_Entries.end()));
+            m_Stats.evictions++;
+        }
+    }
+
+    // The index keys view the strings owned by the list entries
+    std::list<Entry> m_Entries;
+    std::unordered_map<std::string_view, Iterator> m_Index;
+    size_t m_MemoryLimit;
+    CacheStats m_Stats;
+};
+
+// Two level cache for expressions evaluated over and over: normalized text
+// to parsed AST, and normalized text to the result and its formatted text.
+// Only expressions that neither read nor assign variables are cached, the
+// result of any other depends on the environment. Results are dropped when
+// Number::precision() or Number::maxTerms() changes.
+class ExpressionCache
+{
+public:
+    struct Result
+    {
+        Number value;
+        std::string text; // value formatted with operator<<
+    };
+
+    explicit ExpressionCache(size_t astMemoryLimit = 4 << 20, size_t resultMemoryLimit = 4 << 20)
+        : m_ASTs(astMemoryLimit), m_Results(resultMemoryLimit)
+    {
+    }
+
+    // Evaluates expr like Expression(expr).eval(), throwing the same errors
+    Result eval(std::string_view expr);
+
+    // Variables are read and assigned in env, see Expression::setEnvironment().
+    // Without one every eval() starts with no variables.
+    void setEnvironment(Environment &env)
+    {
+        m_Env = &env;
+    }
+
+    // eval() throws EvaluationCancelled once flag is set, see
+    // Expression::setCancelFlag(). Cancelled results are not cached.
+    void setCancelFlag(const std::atomic<bool> *flag)
+    {
+        m_Cancel = flag;
+    }
+
+    // The tokens of exp after lex(), one space apart, so spacing differences
+    // map to the same entry but separate tokens are never joined: "1 < = 2"
+    // is not "1 <= 2"
+    static std::string normalize(const Expression &exp);
+
+    // Estimated heap bytes held by value
+    static size_t memoryUsage(const Number &value);
+
+    void setMemoryLimit(size_t astMemoryLimit, size_t resultMemoryLimit)
+    {
+        m_ASTs.setMemoryLimit(astMemoryLimit);
+        m_Results.setMemoryLimit(resultMemoryLimit);
+    }
+    void clear()
+    {
+        m_ASTs.clear();
+        m_Results.clear();
+    }
+
+    const CacheStats &astStats() const
+    {
+        return m_ASTs.stats();
+    }
+    const CacheStats &resultStats() const
+    {
+        return m_Results.stats();
+    }
+
+private:
+    LRUCache<ASTArena> m_ASTs;
+    LRUCache<Result> m_Results;
+    Expression m_Lexer;
+    // Number settings the results were computed with
+    size_t m_Precision = Number::precision();
+    size_t m_MaxTerms = Number::maxTerms();
+    const std::atomic<bool> *m_Cancel = nullptr;
+    Environment *m_Env = nullptr;
+};
+
+#endif
@@ -30,6 +30,7 @@
  */
 #include "ImGuiCalculatorInput.h"
 #include "dejavusans_ttf.h" 
+#include <cstdio>
 
 namespace ImGuiCalculatorInput
 {
@@ -52,10 +53,9 @@ namespace ImGuiCalculatorInput
         {
             ImGuiIO& io = ImGui::GetIO();
 
+            // The embedded font only has these glyphs, see FONT_RANGES in CMakeLists.txt
             static const ImWchar ranges[] = {
-                0x0020, 0x00FF, // Basic Latin + Latin Supplement
-                0x2200, 0x22FF, // Mathematical Operators
-                0x2300, 0x23FF, // Misc Technical (⌫ is here at U+232B)
+                DejaVuSans_ttf_ranges,
                 0,             // End of ranges
             };
             ImFontConfig config;
@@ -64,7 +64,8 @@ namespace ImGuiCalculatorInput
             config.SizePixels = 13.0f;
             defaultFont = io.Fonts->AddFontFromMemoryTTF((void*)DejaVuSans_ttf, DejaVuSans_ttf_len, 13.0f, &config, ranges);
 
-            io.Fonts->Build();
+            // No io.Fonts->Build(), the renderer backend uploads the atlas
+            // itself and glyphs are rasterized the first time a size is drawn
             fontsReady = true;
         }
     }
@@ -90,7 +91,16 @@ namespace ImGuiCalculatorInput
         ImGui::PushID(ImGui::GetID("calcChild"));
         if (display && ImGui::BeginChild(ImGui::GetID(name), ImVec2(0, 0), childFlags, flags))
         {
-            if (!io.WantCaptureKeyboard && ImGui::IsWindowFocused())
+            if (data.pending)
+            {
+                // Only cancelling works until the result arrives, typed
+                // characters are dropped by ImGui at the end of the frame
+                if (ImGui::IsKeyPressed(ImGuiKey_Escape, false))
+                {
+                    data.cancelRequested = true;
+                }
+            }
+            else if (!io.WantCaptureKeyboard && ImGui::IsWindowFocused())
             {
                 for (int i = 0; i < io.InputQueueCharacters.Size; ++i)
                 {
@@ -159,42 +169,52 @@ namespace ImGuiCalculatorInput
 
         ImGui::Dummy(ImVec2(0, blankHeight)); // Add dummy space to fill the available height
 
-        // Render the last expression with a 11px font size
-        // Calculate indentation based on the window size and the text size
-        int indent = ImGui::GetWindowSize().x - (defaultFont->CalcTextSizeA(
-            13.0f, FLT_MAX, 0.0f,
-            data.lastExpr.c_str()).x + 20);
+        // Render the last expression with a 11px font size, right aligned
+        const TextLayout &lastExpr = layoutText(data.lastExprLayout, data.lastExpr, 11.0f);
+        int indent = ImGui::GetWindowSize().x - (lastExpr.width + 20);
         
         ImGui::Dummy(ImVec2(indent, 0)); // Add dummy space for indentation
         ImGui::SameLine();
-        ImGui::PushFont(defaultFont, 11.0f); 
-        ImGui::Text(data.lastExpr.c_str()); // Render the last expression with a 13px font size
+        ImGui::PushFont(defaultFont, lastExpr.fontSize);
+        ImGui::TextUnformatted(data.lastExpr.c_str());
         ImGui::PopFont();
         ImGui::NewLine();
 
-        // Calculate font size based on available height (make text fit nicely above the buttons)
-        float fontSize = textHeight * 0.7f;
-        ImVec2 textSize = defaultFont->CalcTextSizeA(fontSize, FLT_MAX, 0.0f, data.text.c_str());
+        // Font size based on available height (make text fit nicely above the buttons),
+        // reduced if the text is too wide
+        const TextLayout &text = layoutText(data.textLayout, data.text, textHeight * 0.7f,
+                                            ImGui::GetContentRegionAvail().x);
+        float fontSize = text.fontSize;
+        indent = ImGui::GetWindowSize().x - (text.width + 20);
+
+        ImGui::Dummy(ImVec2(indent, 0));
+        ImGui::SameLine();
+        ImGui::PushFont(defaultFont, fontSize);
+        ImGui::TextUnformatted(data.text.c_str());
+        ImGui::PopFont();
 
-        if (textSize.x > ImGui::GetContentRegionAvail().x - 20)
+        // Live preview line, always reserved so the buttons don't move while typing
+        std::string preview = data.preview.empty() ? std::string() : "= " + data.preview;
+        if (data.pending)
         {
-            // If the text is too wide, reduce the font size
-            fontSize = std::max(11.0f, (ImGui::GetContentRegionAvail().x - 40) / textSize.x * fontSize);
+            char buf[64];
+            snprintf(buf, sizeof(buf), "Evaluating... %.1f s (Esc to cancel)", data.pendingSeconds);
+            preview = buf;
         }
-
-        if (fontSize < 11.0f)
+        indent = ImGui::GetWindowSize().x - (layoutText(data.previewLayout, preview, 13.0f).width + 20);
+        if (data.pending)
         {
-            fontSize = 11.0f; // Ensure a minimum font size
+            indent -= 13 + ImGui::GetStyle().ItemSpacing.x;
         }
-
-        indent = ImGui::GetWindowSize().x - (defaultFont->CalcTextSizeA(
-            fontSize, FLT_MAX, 0.0f,
-            data.text.c_str()).x + 20);
-
         ImGui::Dummy(ImVec2(indent, 0));
         ImGui::SameLine();
-        ImGui::PushFont(defaultFont, fontSize);
-        ImGui::Text(data.text.c_str());
+        if (data.pending)
+        {
+            _spinner(6.0f);
+            ImGui::SameLine();
+        }
+        ImGui::PushFont(defaultFont, 13.0f);
+        ImGui::TextDisabled("%s", preview.c_str());
         ImGui::PopFont();
         ImGui::Dummy(ImVec2(0, 80 - fontSize)); // Add some space after the text
 
@@ -219,11 +239,7 @@ namespace ImGuiCalculatorInput
         float availableHeightForButtons = totalHeight - (spacing * (inputRows.size() - 1));
         float buttonHeight = availableHeightForButtons / inputRows.size(); // Distribute height evenly across rows
 
-        fontSize = buttonHeight * 0.7f; // Adjust font size to fit within button height
-        if (fontSize < 11.0f)
-        {
-            fontSize = 11.0f; // Ensure a minimum font size
-        }
+        fontSize = quantizeFontSize(buttonHeight * 0.7f); // Adjust font size to fit within button height
         ImGui::PushFont(defaultFont, fontSize);
 
         // Calculate button width to fill the whole window evenly
@@ -237,6 +253,12 @@ namespace ImGuiCalculatorInput
 
                 if (key.exists)
                 {
+                    // While evaluating only CE is usable, it cancels
+                    bool disabled = data.pending && key.encoded != '\xFF';
+                    if (disabled)
+                    {
+                        ImGui::BeginDisabled();
+                    }
                     if (ImGui::Button(key.text.c_str(), ImVec2(buttonWidth, buttonHeight)))
                     {
                         if (data.error)
@@ -267,15 +289,26 @@ namespace ImGuiCalculatorInput
                         }
                         else if (key.encoded == '\xFF') // CE button
                         {
-                            data.text.clear();
-                            data.enterPressed = false;
-                            data.lastExpr = "";
+                            if (data.pending)
+                            {
+                                data.cancelRequested = true;
+                            }
+                            else
+                            {
+                                data.text.clear();
+                                data.enterPressed = false;
+                                data.lastExpr = "";
+                            }
                         }
                         else
                         {
                             addCharachter(data, key.encoded);
                         }
                     }
+                    if (disabled)
+                    {
+                        ImGui::EndDisabled();
+                    }
                 }
                 else
                 {
@@ -290,6 +323,62 @@ namespace ImGuiCalculatorInput
         ImGui::PopFont();
     }
 
+    void _spinner(float radius)
+    {
+        ImVec2 pos = ImGui::GetCursorScreenPos();
+        ImVec2 size(radius * 2 + 1, ImGui::GetTextLineHeight());
+        ImGui::Dummy(size);
+        ImVec2 center(pos.x + radius, pos.y + size.y / 2);
+
+        // A three quarter arc turning once a second
+        const int segments = 24;
+        const float pi = 3.14159265f;
+        float start = (float)ImGui::GetTime() * 2 * pi;
+        ImDrawList *drawList = ImGui::GetWindowDrawList();
+        drawList->PathClear();
+        drawList->PathArcTo(center, radius, start, start + 1.5f * pi, segments);
+        drawList->PathStroke(ImGui::GetColorU32(ImGuiCol_TextDisabled), 0, 2.0f);
+    }
+
+    // Every distinct size gets its own glyphs rasterized, so sizes that follow
+    // the window are snapped down to a few steps
+    float quantizeFontSize(float size)
+    {
+        static const float sizes[] = {11.0f, 13.0f, 16.0f, 20.0f, 24.0f, 28.0f, 34.0f,
+                                      40.0f, 48.0f, 56.0f, 68.0f, 80.0f, 96.0f};
+        float quantized = sizes[0];
+        for (float step : sizes)
+        {
+            if (step <= size)
+            {
+                quantized = step;
+            }
+        }
+        return quantized;
+    }
+
+    const TextLayout &layoutText(TextLayout &layout, const std::string &text, float fontSize, float availWidth)
+    {
+        float bucket = quantizeFontSize(fontSize);
+        if (layout.text == text && layout.sizeBucket == bucket && layout.availWidth == availWidth)
+        {
+            return layout;
+        }
+        layout.text = text;
+        layout.sizeBucket = bucket;
+        layout.availWidth = availWidth;
+        layout.fontSize = bucket;
+        layout.width = defaultFont->CalcTextSizeA(layout.fontSize, FLT_MAX, 0.0f, text.c_str()).x;
+
+        if (layout.width > availWidth - 20)
+        {
+            // If the text is too wide, reduce the font size
+            layout.fontSize = quantizeFontSize((availWidth - 40) / layout.width * layout.fontSize);
+            layout.width = defaultFont->CalcTextSizeA(layout.fontSize, FLT_MAX, 0.0f, text.c_str()).x;
+        }
+        return layout;
+    }
+
     void addCharachter(CalcInputData &data, ImWchar c)
     {
         if (data.error)
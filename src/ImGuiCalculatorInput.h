@@ -34,16 +34,35 @@
 
 #include <string>
 #include <imgui.h>
+#include <cfloat>
 #include <unordered_map>
 #include <vector>
 
+// Measured width of a line of text, reused while the text, the font size
+// and the available width stay the same
+struct TextLayout
+{
+    std::string text;
+    float sizeBucket = 0.0f; // quantized requested size
+    float availWidth = -1.0f;
+    float fontSize = 0.0f; // size it is drawn at
+    float width = 0.0f;
+};
+
 struct CalcInputData
 {
     std::string text;
     std::string lastExpr;
+    std::string preview; // result of the text being typed, if it evaluates
     bool enterPressed = false;
     bool error = false;
     bool processed = false;
+    bool pending = false;         // entered text is being evaluated
+    bool cancelRequested = false; // Esc or CE while pending
+    float pendingSeconds = 0.0f;
+    TextLayout lastExprLayout;
+    TextLayout textLayout;
+    TextLayout previewLayout;
 };
 
 namespace ImGuiCalculatorInput
@@ -54,6 +73,10 @@ namespace ImGuiCalculatorInput
     CalcInputData& getInput(ImGuiID id);
 
     void _render(ImGuiID id);
+    void _spinner(float radius);
+    float quantizeFontSize(float size);
+    const TextLayout &layoutText(TextLayout &layout, const std::string &text, float fontSize,
+                                 float availWidth = FLT_MAX);
     void addCharachter(CalcInputData &data, ImWchar c);
 
     extern std::unordered_map<ImGuiID, CalcInputData> inputData;
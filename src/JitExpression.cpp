@@ -0,0 +1,484 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           JitExpression.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    x86-64 code generator for double evaluation
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "JitExpression.h"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define CALC_JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // The top two xmm registers are scratch, the rest hold the stack
+    constexpr int scratchRegister = 15;
+    constexpr size_t registerStackDepth = 14;
+
+    // Base registers of the generated function's arguments (SysV ABI)
+    constexpr int constantsBase = 7; // rdi
+    constexpr int variablesBase = 6; // rsi
+    constexpr int tempsBase = 2;     // rdx
+
+    // cmpsd predicates
+    constexpr uint8_t CMP_EQ = 0;
+    constexpr uint8_t CMP_LT = 1;
+    constexpr uint8_t CMP_LE = 2;
+    constexpr uint8_t CMP_NEQ = 4;
+
+    class CodeBuffer
+    {
+    public:
+        // SSE op with two xmm registers: prefix [REX] 0F opcode ModRM
+        void regReg(uint8_t prefix, uint8_t opcode, int reg, int rm)
+        {
+            m_Bytes.push_back(prefix);
+            uint8_t rex = 0x40 | (reg >= 8 ? 0x04 : 0) | (rm >= 8 ? 0x01 : 0);
+            if (rex != 0x40)
+            {
+                m_Bytes.push_back(rex);
+            }
+            m_Bytes.push_back(0x0F);
+            m_Bytes.push_back(opcode);
+            m_Bytes.push_back(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+        }
+
+        // SSE op with an xmm register and [base + disp32]
+        void regMem(uint8_t prefix, uint8_t opcode, int reg, int base, uint32_t disp)
+        {
+            m_Bytes.push_back(prefix);
+            if (reg >= 8)
+            {
+                m_Bytes.push_back(0x44);
+            }
+            m_Bytes.push_back(0x0F);
+            m_Bytes.push_back(opcode);
+            m_Bytes.push_back(static_cast<uint8_t>(0x80 | ((reg & 7) << 3) | base));
+            for (int i = 0; i < 4; ++i)
+            {
+                m_Bytes.push_back(static_cast<uint8_t>(disp >> (8 * i)));
+            }
+        }
+
+        void load(int reg, int base, uint32_t index)
+        {
+            regMem(0xF2, 0x10, reg, base, index * sizeof(double)); // movsd xmm, [base + disp]
+        }
+        void store(int reg, int base, uint32_t index)
+        {
+            regMem(0xF2, 0x11, reg, base, index * sizeof(double)); // movsd [base + disp], xmm
+        }
+        void compare(int a, int b, uint8_t predicate)
+        {
+            regReg(0xF2, 0xC2, a, b); // cmpsd a, b, predicate
+            m_Bytes.push_back(predicate);
+        }
+        void ret()
+        {
+            m_Bytes.push_back(0xC3);
+        }
+
+        const std::vector<uint8_t> &bytes() const
+        {
+            return m_Bytes;
+        }
+
+    private:
+        std::vector<uint8_t> m_Bytes;
+    };
+
+    // Scalar double opcodes: sd suffix uses the F2 prefix, pd bitwise ops 66
+    constexpr uint8_t SD = 0xF2;
+    constexpr uint8_t PD = 0x66;
+    constexpr uint8_t ADDSD = 0x58;
+    constexpr uint8_t MULSD = 0x59;
+    constexpr uint8_t SUBSD = 0x5C;
+    constexpr uint8_t DIVSD = 0x5E;
+    constexpr uint8_t MOVAPD = 0x28;
+    constexpr uint8_t ANDPD = 0x54;
+    constexpr uint8_t ORPD = 0x56;
+    constexpr uint8_t XORPD = 0x57;
+}
+
+JitExpression::JitExpression(const CompiledExpression &code)
+    : m_Code(code.code()), m_MaxStack(code.maxStackDepth()), m_VariableCount(code.variableCount()),
+      m_TempCount(code.tempCount())
+{
+    if (m_Code.empty())
+    {
+        throw std::runtime_error("Evaluating an empty compiled expression");
+    }
+    for (const Number &constant : code.constants())
+    {
+        m_Constants.push_back(constant.approximate());
+    }
+    if (supported() && !generate())
+    {
+        release();
+    }
+}
+
+JitExpression::~JitExpression()
+{
+    release();
+}
+
+JitExpression::JitExpression(JitExpression &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+JitExpression &JitExpression::operator=(JitExpression &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        m_Code = std::move(other.m_Code);
+        m_Constants = std::move(other.m_Constants);
+        m_MaxStack = other.m_MaxStack;
+        m_VariableCount = other.m_VariableCount;
+        m_TempCount = other.m_TempCount;
+        m_Memory = other.m_Memory;
+        m_MappedSize = other.m_MappedSize;
+        m_CodeSize = other.m_CodeSize;
+        m_Function = other.m_Function;
+        other.m_Memory = nullptr;
+        other.m_Function = nullptr;
+        other.m_MappedSize = 0;
+        other.m_CodeSize = 0;
+    }
+    return *this;
+}
+
+bool JitExpression::supported()
+{
+#ifdef CALC_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+void JitExpression::release()
+{
+#ifdef CALC_JIT_X86_64
+    if (m_Memory)
+    {
+        munmap(m_Memory, m_MappedSize);
+    }
+#endif
+    m_Memory = nullptr;
+    m_MappedSize = 0;
+    m_CodeSize = 0;
+    m_Function = nullptr;
+}
+
+bool JitExpression::generate()
+{
+#ifdef CALC_JIT_X86_64
+    if (m_MaxStack > registerStackDepth)
+    {
+        return false;
+    }
+
+    // Constants the generated code needs on top of the expression's own
+    const uint32_t signMask = static_cast<uint32_t>(m_Constants.size());
+    m_Constants.push_back(-0.0);
+    const uint32_t one = static_cast<uint32_t>(m_Constants.size());
+    m_Constants.push_back(1.0);
+
+    CodeBuffer out;
+    int sp = 0; // register holding the next value pushed
+
+    // Turns the comparison mask in register a into 1.0 or 0.0
+    auto maskToBool = [&](int a) {
+        out.load(scratchRegister, constantsBase, one);
+        out.regReg(PD, ANDPD, a, scratchRegister);
+    };
+    // a = b < a or b <= a, for > and >= which cmpsd has no ordered form of
+    auto swappedCompare = [&](int a, int b, uint8_t predicate) {
+        out.regReg(PD, MOVAPD, scratchRegister, b);
+        out.compare(scratchRegister, a, predicate);
+        out.regReg(PD, MOVAPD, a, scratchRegister);
+    };
+    // a = (a != 0) op (b != 0), clobbers b which is popped anyway
+    auto logical = [&](int a, int b, uint8_t op) {
+        out.regReg(PD, XORPD, scratchRegister, scratchRegister);
+        out.compare(a, scratchRegister, CMP_NEQ);
+        out.compare(b, scratchRegister, CMP_NEQ);
+        out.regReg(PD, op, a, b);
+    };
+
+    for (const Instruction &ins : m_Code)
+    {
+        int a = sp - 2; // left operand and result of a binary op
+        int b = sp - 1; // right operand, top of the stack
+        switch (ins.op)
+        {
+        case OpCode::PUSH_CONST:
+            out.load(sp++, constantsBase, ins.operand);
+            break;
+        case OpCode::LOAD_VAR:
+            out.load(sp++, variablesBase, ins.operand);
+            break;
+        case OpCode::STORE_VAR:
+            out.store(sp - 1, variablesBase, ins.operand);
+            break;
+        case OpCode::LOAD_TEMP:
+            out.load(sp++, tempsBase, ins.operand);
+            break;
+        case OpCode::STORE_TEMP:
+            out.store(sp - 1, tempsBase, ins.operand);
+            break;
+        case OpCode::NEG:
+            out.load(scratchRegister, constantsBase, signMask);
+            out.regReg(PD, XORPD, sp - 1, scratchRegister);
+            break;
+        case OpCode::ADD:
+            out.regReg(SD, ADDSD, a, b);
+            sp--;
+            break;
+        case OpCode::SUB:
+            out.regReg(SD, SUBSD, a, b);
+            sp--;
+            break;
+        case OpCode::MUL:
+            out.regReg(SD, MULSD, a, b);
+            sp--;
+            break;
+        case OpCode::DIV:
+            out.regReg(SD, DIVSD, a, b);
+            sp--;
+            break;
+        case OpCode::EQ:
+            out.compare(a, b, CMP_EQ);
+            maskToBool(a);
+            sp--;
+            break;
+        case OpCode::NE:
+            out.compare(a, b, CMP_NEQ);
+            maskToBool(a);
+            sp--;
+            break;
+        case OpCode::LT:
+            out.compare(a, b, CMP_LT);
+            maskToBool(a);
+            sp--;
+            break;
+        case OpCode::LE:
+            out.compare(a, b, CMP_LE);
+            maskToBool(a);
+            sp--;
+            break;
+        case OpCode::GT:
+            swappedCompare(a, b, CMP_LT);
+            maskToBool(a);
+            sp--;
+            break;
+        case OpCode::GE:
+            swappedCompare(a, b, CMP_LE);
+            maskToBool(a);
+            sp--;
+            break;
+        case OpCode::AND:
+            logical(a, b, ANDPD);
+            maskToBool(a);
+            sp--;
+            break;
+        case OpCode::OR:
+            logical(a, b, ORPD);
+            maskToBool(a);
+            sp--;
+            break;
+        default:
+            return false;
+        }
+    }
+    out.ret(); // the result is already in xmm0
+
+    const std::vector<uint8_t> &bytes = out.bytes();
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    m_MappedSize = (bytes.size() + page - 1) / page * page;
+    void *memory = mmap(nullptr, m_MappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        m_MappedSize = 0;
+        return false;
+    }
+    m_Memory = memory;
+    std::memcpy(m_Memory, bytes.data(), bytes.size());
+
+    // Never writable and executable at the same time
+    if (mprotect(m_Memory, m_MappedSize, PROT_READ | PROT_EXEC) != 0)
+    {
+        return false;
+    }
+    m_CodeSize = bytes.size();
+    m_Function = reinterpret_cast<Function>(m_Memory);
+    return true;
+#else
+    return false;
+#endif
+}
+
+double JitExpression::eval(double *variables) const
+{
+    std::vector<double> stack;
+    return eval(stack, variables);
+}
+
+double JitExpression::eval(std::vector<double> &stack, double *variables) const
+{
+    if (m_Function)
+    {
+        // Native code keeps the stack in registers, only the temporaries are here
+        if (stack.size() < m_TempCount)
+        {
+            stack.resize(m_TempCount);
+        }
+        return m_Function(m_Constants.data(), variables, stack.data());
+    }
+    return interpret(stack, variables);
+}
+
+double JitExpression::interpret(double *variables) const
+{
+    std::vector<double> stack;
+    return interpret(stack, variables);
+}
+
+double JitExpression::interpret(std::vector<double> &stack, double *variables) const
+{
+    // Temporaries live after the deepest stack slot
+    if (stack.size() < m_MaxStack + m_TempCount)
+    {
+        stack.resize(m_MaxStack + m_TempCount);
+    }
+    double *sp = stack.data();
+    double *temps = stack.data() + m_MaxStack;
+    const double *constants = m_Constants.data();
+
+    for (const Instruction &ins : m_Code)
+    {
+        switch (ins.op)
+        {
+        case OpCode::PUSH_CONST:
+            *sp++ = constants[ins.operand];
+            break;
+        case OpCode::LOAD_VAR:
+            *sp++ = variables[ins.operand];
+            break;
+        case OpCode::STORE_VAR:
+            variables[ins.operand] = sp[-1];
+            break;
+        case OpCode::LOAD_TEMP:
+            *sp++ = temps[ins.operand];
+            break;
+        case OpCode::STORE_TEMP:
+            temps[ins.operand] = sp[-1];
+            break;
+        case OpCode::NEG:
+            sp[-1] = -sp[-1];
+            break;
+        case OpCode::ADD:
+            --sp;
+            sp[-1] = sp[-1] + *sp;
+            break;
+        case OpCode::SUB:
+            --sp;
+            sp[-1] = sp[-1] - *sp;
+            break;
+        case OpCode::MUL:
+            --sp;
+            sp[-1] = sp[-1] * *sp;
+            break;
+        case OpCode::DIV:
+            --sp;
+            sp[-1] = sp[-1] / *sp;
+            break;
+        case OpCode::AND:
+            --sp;
+            sp[-1] = sp[-1] != 0 && *sp != 0;
+            break;
+        case OpCode::OR:
+            --sp;
+            sp[-1] = sp[-1] != 0 || *sp != 0;
+            break;
+        case OpCode::EQ:
+            --sp;
+            sp[-1] = sp[-1] == *sp;
+            break;
+        case OpCode::NE:
+            --sp;
+            sp[-1] = sp[-1] != *sp;
+            break;
+        case OpCode::LT:
+            --sp;
+            sp[-1] = sp[-1] < *sp;
+            break;
+        case OpCode::LE:
+            --sp;
+            sp[-1] = sp[-1] <= *sp;
+            break;
+        case OpCode::GT:
+            --sp;
+            sp[-1] = sp[-1] > *sp;
+            break;
+        case OpCode::GE:
+            --sp;
+            sp[-1] = sp[-1] >= *sp;
+            break;
+        case OpCode::NONE:
+            throw std::runtime_error("Invalid instruction");
+        }
+    }
+    return stack[0];
+}
+
+bool JitExpression::verify(const double *variables) const
+{
+    std::vector<double> jitVariables(variables, variables + m_VariableCount);
+    std::vector<double> interpreterVariables = jitVariables;
+
+    std::vector<double> stack;
+    double jit = eval(stack, jitVariables.data());
+    double interpreted = interpret(stack, interpreterVariables.data());
+
+    uint64_t jitBits, interpretedBits;
+    std::memcpy(&jitBits, &jit, sizeof(double));
+    std::memcpy(&interpretedBits, &interpreted, sizeof(double));
+    if (jitBits != interpretedBits)
+    {
+        return false;
+    }
+    return std::memcmp(jitVariables.data(), interpreterVariables.data(), m_VariableCount * sizeof(double)) == 0;
+}
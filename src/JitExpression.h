@@ -0,0 +1,103 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           JitExpression.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Native x86-64 code for expressions evaluated in doubles
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _JIT_EXPRESSION_H_
+#define _JIT_EXPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CompiledExpression.h"
+
+// Translates the bytecode of an expression to straight-line SSE2 machine code
+// in an executable mapping, keeping the evaluation stack in xmm registers.
+// Only available on Linux x86-64 and for expressions whose stack fits in the
+// registers, otherwise eval() runs a double interpreter over the same
+// bytecode. Both produce bit-identical results.
+class JitExpression
+{
+public:
+    explicit JitExpression(const CompiledExpression &code);
+    ~JitExpression();
+
+    JitExpression(const JitExpression &) = delete;
+    JitExpression &operator=(const JitExpression &) = delete;
+    JitExpression(JitExpression &&other) noexcept;
+    JitExpression &operator=(JitExpression &&other) noexcept;
+
+    // variables holds one double per environment slot, assignments write to
+    // it. The stack vector is scratch space reused between calls, like in
+    // CompiledExpression::eval(), so threads can share one JitExpression as
+    // long as each passes its own stack and variables.
+    double eval(double *variables) const;
+    double eval(std::vector<double> &stack, double *variables) const;
+    double interpret(double *variables) const;
+    double interpret(std::vector<double> &stack, double *variables) const;
+
+    // Runs both paths on a copy of variables and compares the bit patterns
+    bool verify(const double *variables) const;
+
+    bool compiled() const
+    {
+        return m_Function != nullptr;
+    }
+    size_t codeSize() const
+    {
+        return m_CodeSize;
+    }
+    uint32_t variableCount() const
+    {
+        return m_VariableCount;
+    }
+
+    // Whether this build and machine can run generated code at all
+    static bool supported();
+
+private:
+    using Function = double (*)(const double *constants, double *variables, double *temps);
+
+    void release();
+    // Translates m_Code, false if it does not fit the register stack
+    bool generate();
+
+    std::vector<Instruction> m_Code;
+    std::vector<double> m_Constants;
+    size_t m_MaxStack = 0;
+    uint32_t m_VariableCount = 0;
+    uint32_t m_TempCount = 0;
+
+    void *m_Memory = nullptr;
+    size_t m_MappedSize = 0;
+    size_t m_CodeSize = 0;
+    Function m_Function = nullptr;
+};
+
+#endif
@@ -0,0 +1,231 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           MathConstants.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    π, e and √2 to any precision, cached between requests
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "MathConstants.h"
+#include <cmath>
+#include <mutex>
+
+using boost::multiprecision::cpp_int;
+
+namespace
+{
+    // Extra bits computed so the truncated result is within one unit
+    const size_t guardBits = 32;
+
+    std::mutex s_Mutex;
+
+    // floor(sqrt(n) * 2^bits), refined by Newton from the last result
+    class Root
+    {
+    public:
+        explicit Root(unsigned n) : m_N(n), m_Value(boost::multiprecision::sqrt(cpp_int(n))) {}
+
+        const cpp_int &get(size_t bits)
+        {
+            if (bits <= m_Bits)
+            {
+                return m_Value;
+            }
+            cpp_int square = cpp_int(m_N) << (2 * bits);
+            // One above the last root is above the new one, and Newton
+            // decreases monotonically from above
+            cpp_int x = (m_Value + 1) << (bits - m_Bits);
+            while (true)
+            {
+                cpp_int next = (x + square / x) >> 1;
+                if (next >= x)
+                {
+                    break;
+                }
+                x = std::move(next);
+            }
+            m_Value = std::move(x);
+            m_Bits = bits;
+            return m_Value;
+        }
+
+        size_t bits() const
+        {
+            return m_Bits;
+        }
+
+    private:
+        unsigned m_N;
+        cpp_int m_Value;
+        size_t m_Bits = 0;
+    };
+
+    // Sum of the series terms [0, terms) by binary splitting, in the form
+    // of P, Q, T of the usual notation. New terms are split separately and
+    // merged onto the old sum.
+    template <typename Series>
+    struct Splitting
+    {
+        cpp_int p, q, t;
+        size_t terms = 0;
+
+        void extend(size_t count)
+        {
+            if (count <= terms)
+            {
+                return;
+            }
+            if (terms == 0)
+            {
+                *this = split(0, count);
+            }
+            else
+            {
+                Series::merge(*this, split(terms, count));
+            }
+            terms = count;
+        }
+
+        static Splitting split(size_t a, size_t b)
+        {
+            if (b - a == 1)
+            {
+                Splitting out;
+                Series::term(a, out);
+                return out;
+            }
+            size_t m = a + (b - a) / 2;
+            Splitting left = split(a, m);
+            Series::merge(left, split(m, b));
+            return left;
+        }
+    };
+
+    // Chudnovsky: π = 426880 * sqrt(10005) * Q / T, 47 bits per term
+    struct Chudnovsky
+    {
+        static void term(size_t k, Splitting<Chudnovsky> &out)
+        {
+            if (k == 0)
+            {
+                out.p = out.q = 1;
+            }
+            else
+            {
+                cpp_int n = k;
+                out.p = (6 * n - 5) * (2 * n - 1) * (6 * n - 1);
+                out.q = n * n * n * cpp_int(10939058860032000ull);
+            }
+            out.t = out.p * (13591409 + 545140134 * cpp_int(k));
+            if (k & 1)
+            {
+                out.t = -out.t;
+            }
+        }
+
+        static void merge(Splitting<Chudnovsky> &left, const Splitting<Chudnovsky> &right)
+        {
+            left.t = left.t * right.q + left.p * right.t;
+            left.p *= right.p;
+            left.q *= right.q;
+        }
+    };
+
+    // e = 1 + P / Q, where P / Q is the sum of a! / k! for k in (a, b]
+    struct Factorials
+    {
+        static void term(size_t k, Splitting<Factorials> &out)
+        {
+            out.p = 1;
+            out.q = k + 1;
+        }
+
+        static void merge(Splitting<Factorials> &left, const Splitting<Factorials> &right)
+        {
+            left.p = left.p * right.q + right.p;
+            left.q *= right.q;
+        }
+    };
+
+    struct Cache
+    {
+        cpp_int value;
+        size_t bits = 0;
+
+        cpp_int get(size_t wanted) const
+        {
+            return value >> (bits - wanted);
+        }
+    };
+
+    Root s_Sqrt2(2);
+    Root s_Sqrt10005(10005);
+    Splitting<Chudnovsky> s_PiSeries;
+    Splitting<Factorials> s_ESeries;
+    Cache s_Pi, s_E;
+}
+
+namespace MathConstants
+{
+    cpp_int pi(size_t bits)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        if (bits + guardBits > s_Pi.bits)
+        {
+            size_t working = bits + guardBits;
+            s_PiSeries.extend(working / 47 + 2);
+            cpp_int root = s_Sqrt10005.get(working) >> (s_Sqrt10005.bits() - working);
+            s_Pi.value = 426880 * root * s_PiSeries.q / s_PiSeries.t;
+            s_Pi.bits = working;
+        }
+        return s_Pi.get(bits);
+    }
+
+    cpp_int e(size_t bits)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        if (bits + guardBits > s_E.bits)
+        {
+            size_t working = bits + guardBits;
+            // Enough terms for the first one left out, 1 / n!, to be below 2^-working
+            size_t terms = 1;
+            for (double log2Factorial = 0; log2Factorial < working; ++terms)
+            {
+                log2Factorial += std::log2(static_cast<double>(terms + 1));
+            }
+            s_ESeries.extend(terms);
+            s_E.value = ((s_ESeries.q + s_ESeries.p) << working) / s_ESeries.q;
+            s_E.bits = working;
+        }
+        return s_E.get(bits);
+    }
+
+    cpp_int sqrt2(size_t bits)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        const cpp_int &root = s_Sqrt2.get(bits);
+        return root >> (s_Sqrt2.bits() - bits);
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           MathConstants.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    π, e and √2 to any precision, cached between requests
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _MATH_CONSTANTS_H_
+#define _MATH_CONSTANTS_H_
+
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstddef>
+
+// Fixed point values of the symbolic constants: the integer c with
+// c / 2^bits within one unit of the constant. The series and roots behind
+// them are kept, so asking for more bits continues them from where the
+// last request stopped and asking for fewer is a shift. Thread safe.
+namespace MathConstants
+{
+    boost::multiprecision::cpp_int pi(size_t bits);
+    boost::multiprecision::cpp_int e(size_t bits);
+    boost::multiprecision::cpp_int sqrt2(size_t bits);
+}
+
+#endif
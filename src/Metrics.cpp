@@ -0,0 +1,196 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Metrics.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Lock-free histograms of per-phase timings and sizes
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "Metrics.h"
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+
+namespace
+{
+    std::array<Histogram, static_cast<size_t>(Metric::COUNT)> histograms;
+
+    const char *const names[] = {
+        "lex_ns", "parse_ns", "eval_ns", "format_ns", "tokens", "nodes", "result_bits", "frame_us",
+        "idle_us",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(Metric::COUNT),
+                  "every metric needs a name");
+
+    int highestBit(uint64_t value)
+    {
+        return 63 - __builtin_clzll(value);
+    }
+}
+
+// Values below 4 get a bucket each, larger ones 4 buckets per power of two
+size_t Histogram::bucketOf(uint64_t value)
+{
+    if (value < 4)
+    {
+        return static_cast<size_t>(value);
+    }
+    int msb = highestBit(value);
+    size_t sub = (value >> (msb - 2)) & 3;
+    return static_cast<size_t>(msb - 1) * 4 + sub;
+}
+
+uint64_t Histogram::bucketMidpoint(size_t bucket)
+{
+    if (bucket < 4)
+    {
+        return bucket;
+    }
+    int msb = static_cast<int>(bucket / 4) + 1;
+    uint64_t width = uint64_t(1) << (msb - 2);
+    uint64_t lower = (4 + bucket % 4) * width;
+    return lower + width / 2;
+}
+
+void Histogram::record(uint64_t value)
+{
+    m_Buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    m_Count.fetch_add(1, std::memory_order_relaxed);
+    m_Sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = m_Min.load(std::memory_order_relaxed);
+    while (value < seen && !m_Min.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+    {
+    }
+    seen = m_Max.load(std::memory_order_relaxed);
+    while (value > seen && !m_Max.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+HistogramSnapshot Histogram::snapshot() const
+{
+    HistogramSnapshot out;
+    out.count = m_Count.load(std::memory_order_relaxed);
+    out.sum = m_Sum.load(std::memory_order_relaxed);
+    out.min = out.count ? m_Min.load(std::memory_order_relaxed) : 0;
+    out.max = m_Max.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < out.buckets.size(); ++i)
+    {
+        out.buckets[i] = m_Buckets[i].load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+void Histogram::reset()
+{
+    for (auto &bucket : m_Buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_Count.store(0, std::memory_order_relaxed);
+    m_Sum.store(0, std::memory_order_relaxed);
+    m_Min.store(UINT64_MAX, std::memory_order_relaxed);
+    m_Max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t HistogramSnapshot::percentile(double p) const
+{
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets)
+    {
+        total += bucket;
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p * (total - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen > rank)
+        {
+            return std::min(std::max(Histogram::bucketMidpoint(i), min), max);
+        }
+    }
+    return max;
+}
+
+namespace Metrics
+{
+    std::atomic<bool> enabledFlag{false};
+
+    Histogram &histogram(Metric metric)
+    {
+        return histograms[static_cast<size_t>(metric)];
+    }
+
+    const char *name(Metric metric)
+    {
+        return names[static_cast<size_t>(metric)];
+    }
+
+    void reset()
+    {
+        for (Histogram &histogram : histograms)
+        {
+            histogram.reset();
+        }
+    }
+
+    void writeJson(std::ostream &out)
+    {
+        out << "{\n";
+        for (size_t i = 0; i < histograms.size(); ++i)
+        {
+            HistogramSnapshot snapshot = histograms[i].snapshot();
+            out << "  \"" << names[i] << "\": {\"count\": " << snapshot.count << ", \"mean\": " << snapshot.mean()
+                << ", \"min\": " << snapshot.min << ", \"p50\": " << snapshot.percentile(0.5)
+                << ", \"p90\": " << snapshot.percentile(0.9) << ", \"p99\": " << snapshot.percentile(0.99)
+                << ", \"max\": " << snapshot.max << ", \"buckets\": {";
+            bool first = true;
+            for (size_t bucket = 0; bucket < snapshot.buckets.size(); ++bucket)
+            {
+                if (snapshot.buckets[bucket])
+                {
+                    out << (first ? "" : ", ") << "\"" << Histogram::bucketMidpoint(bucket)
+                        << "\": " << snapshot.buckets[bucket];
+                    first = false;
+                }
+            }
+            out << "}}" << (i + 1 < histograms.size() ? "," : "") << "\n";
+        }
+        out << "}\n";
+    }
+
+    bool writeJson(const std::string &path)
+    {
+        std::ofstream out(path);
+        writeJson(out);
+        return static_cast<bool>(out);
+    }
+}
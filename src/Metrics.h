@@ -0,0 +1,154 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Metrics.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Lock-free histograms of per-phase timings and sizes
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+enum class Metric : uint8_t
+{
+    LEX_NS,
+    PARSE_NS,
+    EVAL_NS,
+    FORMAT_NS,
+    TOKENS,
+    NODES,
+    RESULT_BITS, // bits of the largest numerator or denominator of a result
+    FRAME_US,    // work per frame, without the wait for the next one
+    IDLE_US,     // time blocked waiting for input between frames
+    COUNT
+};
+
+struct HistogramSnapshot
+{
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    std::array<uint64_t, 252> buckets{};
+
+    double mean() const
+    {
+        return count ? static_cast<double>(sum) / count : 0;
+    }
+    // Approximate, values are bucketed with 2 bits of mantissa
+    uint64_t percentile(double p) const;
+};
+
+// Log-linear histogram updated with relaxed atomics only, so any thread can
+// record into it without locking. A snapshot taken while others record may
+// be off by the values in flight.
+class Histogram
+{
+public:
+    void record(uint64_t value);
+    HistogramSnapshot snapshot() const;
+    void reset();
+
+    static size_t bucketOf(uint64_t value);
+    static uint64_t bucketMidpoint(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, 252> m_Buckets{};
+    std::atomic<uint64_t> m_Count{0};
+    std::atomic<uint64_t> m_Sum{0};
+    std::atomic<uint64_t> m_Min{UINT64_MAX};
+    std::atomic<uint64_t> m_Max{0};
+};
+
+// Process wide metrics, disabled by default so the evaluators used by the
+// CLI, the server and the benchmarks pay a single relaxed load per phase
+namespace Metrics
+{
+    extern std::atomic<bool> enabledFlag;
+
+    inline bool enabled()
+    {
+        return enabledFlag.load(std::memory_order_relaxed);
+    }
+    inline void setEnabled(bool enabled)
+    {
+        enabledFlag.store(enabled, std::memory_order_relaxed);
+    }
+
+    Histogram &histogram(Metric metric);
+    const char *name(Metric metric);
+
+    inline void record(Metric metric, uint64_t value)
+    {
+        if (enabled())
+        {
+            histogram(metric).record(value);
+        }
+    }
+
+    void reset();
+    void writeJson(std::ostream &out);
+    // Returns false if the file cannot be written
+    bool writeJson(const std::string &path);
+
+    // Records the time until it goes out of scope, in ns
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Metric metric) : m_Metric(metric), m_Enabled(enabled())
+        {
+            if (m_Enabled)
+            {
+                m_Start = std::chrono::steady_clock::now();
+            }
+        }
+        ~ScopedTimer()
+        {
+            if (m_Enabled)
+            {
+                auto elapsed = std::chrono::steady_clock::now() - m_Start;
+                histogram(m_Metric).record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            }
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Metric m_Metric;
+        bool m_Enabled;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+}
+
+#endif
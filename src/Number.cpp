@@ -0,0 +1,252 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Number.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    High precision approximation of Numbers
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "Number.h"
+#include "MathConstants.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+using boost::multiprecision::cpp_int;
+
+namespace
+{
+    // Extra bits carried through the powers and the sum
+    const size_t guardBits = 40;
+
+    size_t bitLength(const cpp_int &value)
+    {
+        return value == 0 ? 0 : boost::multiprecision::msb(boost::multiprecision::abs(value)) + 1;
+    }
+
+    // num * 2^shift / den, truncated
+    cpp_int scaledQuotient(const cpp_int &num, const cpp_int &den, long shift)
+    {
+        return shift >= 0 ? cpp_int(num << shift) / den : num / cpp_int(den << -shift);
+    }
+
+    // m / 2^shift rounded to nearest with bits significant bits, halves
+    // away from zero. Trailing zeros are taken off first, since building
+    // the cpp_rational runs a gcd that costs more than the rest.
+    Rational dyadic(cpp_int m, long shift, size_t bits)
+    {
+        if (m == 0)
+        {
+            return Rational();
+        }
+        bool negative = m < 0;
+        m = boost::multiprecision::abs(m);
+        size_t length = bitLength(m);
+        if (length > bits)
+        {
+            size_t drop = length - bits;
+            m = ((m >> (drop - 1)) + 1) >> 1;
+            shift -= static_cast<long>(drop);
+        }
+        size_t zeros = boost::multiprecision::lsb(m);
+        m >>= zeros;
+        shift -= static_cast<long>(zeros);
+        if (negative)
+        {
+            m = -m;
+        }
+        return Rational(shift >= 0 ? Rational::Big(m, cpp_int(1) << shift) : Rational::Big(cpp_int(m << -shift)));
+    }
+
+    // m * 2^exp, with m cut to the working precision after each operation
+    struct Float
+    {
+        cpp_int m;
+        long exp;
+    };
+
+    Float normalize(Float x, size_t bits)
+    {
+        size_t length = bitLength(x.m);
+        if (length > bits)
+        {
+            x.m >>= length - bits;
+            x.exp += static_cast<long>(length - bits);
+        }
+        return x;
+    }
+
+    Float multiply(const Float &a, const Float &b, size_t bits)
+    {
+        return normalize({a.m * b.m, a.exp + b.exp}, bits);
+    }
+
+    Float inverse(const Float &x, size_t bits)
+    {
+        return normalize({(cpp_int(1) << (2 * bits)) / x.m, -x.exp - static_cast<long>(2 * bits)}, bits);
+    }
+
+    Float power(Float base, unsigned exponent, size_t bits)
+    {
+        Float out{1, 0};
+        while (exponent != 0)
+        {
+            if (exponent & 1)
+            {
+                out = multiply(out, base, bits);
+            }
+            exponent >>= 1;
+            if (exponent != 0)
+            {
+                base = multiply(base, base, bits);
+            }
+        }
+        return out;
+    }
+
+    Float basisValue(const NumberClass::Basis &basis, size_t bits)
+    {
+        Float out{1, 0};
+        auto factor = [&](int exponent, cpp_int (*constant)(size_t)) {
+            if (exponent == 0)
+            {
+                return;
+            }
+            Float value = power({constant(bits), -static_cast<long>(bits)}, std::abs(exponent), bits);
+            out = multiply(out, exponent < 0 ? inverse(value, bits) : value, bits);
+        };
+        factor(basis.pi, MathConstants::pi);
+        factor(basis.e, MathConstants::e);
+        factor(basis.sqrt2, MathConstants::sqrt2);
+        return out;
+    }
+
+    // About log2 |value|, one too large at most
+    long magnitude(const Rational::Big &value)
+    {
+        return static_cast<long>(bitLength(boost::multiprecision::numerator(value))) -
+               static_cast<long>(bitLength(boost::multiprecision::denominator(value))) + 1;
+    }
+    // The sum of the parts times 2^fraction, truncated. fraction leaves
+    // bits + guardBits bits above the point for the largest part.
+    cpp_int fixedSum(const NumberClass &number, size_t bits, long &fraction)
+    {
+        const Rational &rationalPart = number.rationalPart;
+        long largest = rationalPart.isZero() ? LONG_MIN : magnitude(rationalPart.toBig());
+        for (const NumberClass::Term &term : number.terms)
+        {
+            double basis = term.basis.pi * std::log2(M_PI) + term.basis.e * std::log2(M_E) + term.basis.sqrt2 * 0.5;
+            largest = std::max(largest, magnitude(term.coeff.toBig()) + static_cast<long>(std::ceil(basis)));
+        }
+        fraction = static_cast<long>(bits + guardBits) - largest;
+        size_t working = bits + guardBits + 8;
+
+        cpp_int sum;
+        if (!rationalPart.isZero())
+        {
+            Rational::Big value = rationalPart.toBig();
+            sum = scaledQuotient(boost::multiprecision::numerator(value), boost::multiprecision::denominator(value),
+                                 fraction);
+        }
+        for (const NumberClass::Term &term : number.terms)
+        {
+            Float basis = basisValue(term.basis, working);
+            Rational::Big coeff = term.coeff.toBig();
+            sum += scaledQuotient(boost::multiprecision::numerator(coeff) * basis.m,
+                                  boost::multiprecision::denominator(coeff), basis.exp + fraction);
+        }
+        return sum;
+    }
+}
+
+Rational NumberClass::approximate(size_t bits) const
+{
+    if (terms.empty())
+    {
+        return rounded(rationalPart, bits);
+    }
+    long fraction;
+    cpp_int sum = fixedSum(*this, bits, fraction);
+    return dyadic(std::move(sum), fraction, bits);
+}
+
+int NumberClass::sign() const
+{
+    if (terms.empty())
+    {
+        return rationalPart.sign();
+    }
+
+    // Each part in double is within a few hundred ulps (the powers of the
+    // rounded constants), the sum adds one ulp of the total per addition.
+    // Parts near the ends of the double range make no bound, skip those.
+    double sum = rationalPart.toDouble();
+    double total = std::fabs(sum);
+    bool usable = rationalPart.isZero() || total > 0x1p-900;
+    for (const Term &term : terms)
+    {
+        double value = term.coeff.toDouble() * term.basis.approximate();
+        usable = usable && std::fabs(value) > 0x1p-900;
+        sum += value;
+        total += std::fabs(value);
+    }
+    if (usable && total < 0x1p900)
+    {
+        double error = total * DBL_EPSILON * static_cast<double>(512 + terms.size() + 1);
+        if (std::fabs(sum) > error)
+        {
+            return sum > 0 ? 1 : -1;
+        }
+    }
+
+    // Each part of the fixed point sum is off by less than 9 units, so the
+    // sign is known once the sum is further from zero than that. A nonzero
+    // sum of distinct bases is not expected to be tiny for long, the last
+    // step gives up and calls it zero.
+    const size_t maxBits = 1 << 16;
+    for (size_t bits = 128;; bits *= 2)
+    {
+        long fraction;
+        cpp_int fixed = fixedSum(*this, bits, fraction);
+        if (boost::multiprecision::abs(fixed) > 16 * (terms.size() + 1) || bits >= maxBits)
+        {
+            return fixed.sign();
+        }
+    }
+}
+
+Rational NumberClass::rounded(const Rational& value, size_t bits)
+{
+    if (value.isZero())
+    {
+        return value;
+    }
+    Rational::Big big = value.toBig();
+    const cpp_int &num = boost::multiprecision::numerator(big);
+    const cpp_int &den = boost::multiprecision::denominator(big);
+    // Scaled so the quotient has a bit more than needed for the rounding
+    long shift = static_cast<long>(bits) - magnitude(big) + 2;
+    return dyadic(scaledQuotient(num, den, shift), shift, bits);
+}
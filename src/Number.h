@@ -36,8 +36,16 @@
 
 #include <boost/multiprecision/cpp_int.hpp>
 #include <cmath>
+#include "NumberLiteral.h"
+#include "Rational.h"
+#include <algorithm>
+#include <atomic>
 #include <optional>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
 
 class NumberClass;
 
@@ -48,155 +56,356 @@ class NumberClass {
 public:
     using BigRational = boost::multiprecision::cpp_rational;
 
-    enum class Tag {
-        None,
-        Pi,
-        E,
-        Sqrt2,
-        Custom  // For future extension
+    // Product of the symbolic constants π^pi · e^e · √2^sqrt2. √2² is
+    // rational, so the √2 exponent is always 0 or 1.
+    struct Basis {
+        int8_t pi = 0;
+        int8_t e = 0;
+        uint8_t sqrt2 = 0;
+
+        bool isOne() const { return pi == 0 && e == 0 && sqrt2 == 0; }
+        uint32_t key() const {
+            return static_cast<uint32_t>(static_cast<uint8_t>(pi)) << 16 |
+                   static_cast<uint32_t>(static_cast<uint8_t>(e)) << 8 | sqrt2;
+        }
+        bool operator==(const Basis& other) const { return key() == other.key(); }
+        bool operator<(const Basis& other) const { return key() < other.key(); }
+        double approximate() const {
+            return std::pow(M_PI, pi) * std::pow(M_E, e) * (sqrt2 ? std::sqrt(2.0) : 1.0);
+        }
+    };
+
+    // coeff · basis, coeff is never zero
+    struct Term {
+        Basis basis;
+        Rational coeff;
     };
 
-    BigRational rationalPart;     // e.g., 42, 1/3
-    BigRational irrationalPart;   // e.g., 2 → 2π
-    Tag tag = Tag::None;
+    Rational rationalPart;     // e.g., 42, 1/3
+    std::vector<Term> terms;   // e.g., 2π, π²/3, sorted by basis, empty for rationals
+    // 0 when exact, otherwise the significant bits of the least precise
+    // approximation the value was computed from, see maxTerms() and precision()
+    size_t inexactBits = 0;
 
     // Constructors
     NumberClass() = default;
     NumberClass(int val) : rationalPart(val) {}
     NumberClass(const BigRational& val) : rationalPart(val) {}
-    NumberClass(double val) : rationalPart(BigRational(val)) {}
-    NumberClass(BigRational rational, BigRational irrational, Tag t)
-        : rationalPart(std::move(rational)), irrationalPart(std::move(irrational)), tag(t) {}
-    NumberClass(std::string str) {
-        try {
-            rationalPart = BigRational(str);
-            tag = Tag::None;
-            irrationalPart = 0; // No irrational part
-        } catch (const std::exception& e) {
-            // If parsing fails, we assume it's a string with a decimal
-            if (str.find('.') != std::string::npos) {
-                rationalPart = BigRational(std::stod(str));
-                tag = Tag::None;
-                irrationalPart = 0; // No irrational part
-            }
-        }
-        // Attempt to parse the string for irrational parts
-        if (str.find("pi") != std::string::npos || str.find("π") != std::string::npos) {
-            tag = Tag::Pi;
-            irrationalPart = 1; // Default coefficient for π
-        } else if (str.find("e") != std::string::npos) {
-            tag = Tag::E;
-            irrationalPart = 1; // Default coefficient for e
-        } else if (str.find("sqrt(2)") != std::string::npos || str.find("√2") != std::string::npos) {
-            tag = Tag::Sqrt2;
-            irrationalPart = 1; // Default coefficient for √2
+    NumberClass(const Rational& val) : rationalPart(val) {}
+    NumberClass(double val) : rationalPart(val) {}
+    NumberClass(Rational rational, Basis basis, Rational coeff) : rationalPart(std::move(rational)) {
+        add(basis, std::move(coeff));
+    }
+    // A number literal (see NumberLiteral::parse) or one of the constants
+    // "pi", "π", "e", "sqrt(2)", "√2". Throws on anything else.
+    NumberClass(std::string_view str) {
+        const char* last = str.data() + str.size();
+        std::from_chars_result result = NumberLiteral::parse(str.data(), last, rationalPart);
+        if (result.ec == std::errc() && result.ptr == last) return;
+        rationalPart = Rational();
+        if (str == "pi" || str == "π") {
+            add(constant(&Basis::pi), 1);
+        } else if (str == "e") {
+            add(constant(&Basis::e), 1);
+        } else if (str == "sqrt(2)" || str == "√2") {
+            Basis basis;
+            basis.sqrt2 = 1;
+            add(basis, 1);
+        } else {
+            throw std::runtime_error((result.ec == std::errc::result_out_of_range ? "Number out of range: " : "Invalid number: ") +
+                                    std::string(str));
         }
     }
 
-    static NumberClass pi(BigRational coeff = 1) { return NumberClass(0, coeff, Tag::Pi); }
-    static NumberClass e(BigRational coeff = 1)  { return NumberClass(0, coeff, Tag::E); }
-    static NumberClass sqrt2(BigRational coeff = 1) { return NumberClass(0, coeff, Tag::Sqrt2); }
+    static NumberClass pi(Rational coeff = 1) { return NumberClass(0, constant(&Basis::pi), std::move(coeff)); }
+    static NumberClass e(Rational coeff = 1)  { return NumberClass(0, constant(&Basis::e), std::move(coeff)); }
+    static NumberClass sqrt2(Rational coeff = 1) {
+        Basis basis;
+        basis.sqrt2 = 1;
+        return NumberClass(0, basis, std::move(coeff));
+    }
+
+    // Results with more symbolic terms than this are computed in double
+    // precision instead, so repeated products cannot grow without bound
+    static size_t maxTerms() { return s_MaxTerms.load(std::memory_order_relaxed); }
+    static void setMaxTerms(size_t count) { s_MaxTerms.store(count, std::memory_order_relaxed); }
 
-    // Arithmetic
+    // Results that cannot stay exact are rounded to this many significant
+    // bits, with π, e and √2 from MathConstants. 0 uses double instead.
+    static size_t precision() { return s_Precision.load(std::memory_order_relaxed); }
+    static void setPrecision(size_t bits) { s_Precision.store(bits, std::memory_order_relaxed); }
+
+    // Arithmetic, inexact when an operand is or the result has to be approximated
     NumberClass operator+(const NumberClass& other) const {
-        if (tag == other.tag) {
-            return NumberClass(rationalPart + other.rationalPart,
-                          irrationalPart + other.irrationalPart,
-                          tag);
-        } else if (isPureRational() && other.isPureRational()) {
+        if (terms.empty() && other.terms.empty() && !(inexactBits | other.inexactBits)) {
             return NumberClass(rationalPart + other.rationalPart);
         }
-        return approximate() + other.approximate();
+        return withOperands(plus(other), other);
     }
 
     NumberClass operator-(const NumberClass& other) const {
-        if (tag == other.tag) {
-            return NumberClass(rationalPart - other.rationalPart,
-                          irrationalPart - other.irrationalPart,
-                          tag);
-        } else if (isPureRational() && other.isPureRational()) {
-            return NumberClass(rationalPart - other.rationalPart);
+        if (terms.empty() && other.terms.empty()) {
+            return withOperands(NumberClass(rationalPart - other.rationalPart), other);
         }
-        return approximate() - other.approximate();
+        return *this + (-other);
     }
 
-    // For now, multiplication is numeric fallback (can be extended)
     NumberClass operator*(const NumberClass& other) const {
-        return NumberClass(approximate() * other.approximate());
+        return withOperands(times(other), other);
     }
 
+    // Exact when the divisor is a single term, e.g. 6π / 2π = 3
     NumberClass operator/(const NumberClass& other) const {
-        return NumberClass(approximate() / other.approximate());
+        return withOperands(dividedBy(other), other);
+    }
+
+private:
+    NumberClass plus(const NumberClass& other) const {
+        NumberClass out(rationalPart + other.rationalPart);
+        out.terms.reserve(terms.size() + other.terms.size());
+        // Both sorted by basis, merge them
+        auto a = terms.begin(), b = other.terms.begin();
+        while (a != terms.end() || b != other.terms.end()) {
+            if (b == other.terms.end() || (a != terms.end() && a->basis < b->basis)) {
+                out.terms.push_back(*a++);
+            } else if (a == terms.end() || b->basis < a->basis) {
+                out.terms.push_back(*b++);
+            } else {
+                Rational sum = a->coeff + b->coeff;
+                if (!sum.isZero()) {
+                    out.terms.push_back({a->basis, std::move(sum)});
+                }
+                ++a;
+                ++b;
+            }
+        }
+        if (out.terms.size() > maxTerms()) {
+            if (precision() == 0) return fallback(NumberClass(approximate() + other.approximate()));
+            return fallback(NumberClass(out.approximate(precision())));
+        }
+        return out;
+    }
+
+    NumberClass times(const NumberClass& other) const {
+        if (other.terms.empty()) {
+            return scaled(other.rationalPart);
+        }
+        if (terms.empty()) {
+            return other.scaled(rationalPart);
+        }
+        // Multiply out, the rational parts act as terms with basis 1
+        NumberClass out;
+        auto each = [](const NumberClass& n, auto f) {
+            if (!n.rationalPart.isZero()) f(Basis(), n.rationalPart);
+            for (const Term& term : n.terms) f(term.basis, term.coeff);
+        };
+        bool overflow = false;
+        each(*this, [&](const Basis& left, const Rational& a) {
+            each(other, [&](const Basis& right, const Rational& b) {
+                Rational coeff = a * b;
+                std::optional<Basis> basis = multiply(left, right, coeff);
+                if (!basis) {
+                    overflow = true;
+                    return;
+                }
+                out.add(*basis, std::move(coeff));
+            });
+        });
+        if (overflow || out.terms.size() > maxTerms()) {
+            size_t bits = precision();
+            if (bits == 0) return fallback(NumberClass(approximate() * other.approximate()));
+            if (!overflow) return fallback(NumberClass(out.approximate(bits)));
+            return fallback(NumberClass(rounded(approximate(bits + 8) * other.approximate(bits + 8), bits)));
+        }
+        return out;
     }
 
+    NumberClass dividedBy(const NumberClass& other) const {
+        if (other.terms.empty()) {
+            return scaled(other.rationalPart.inverse());
+        }
+        if (other.terms.size() == 1 && other.rationalPart.isZero()) {
+            // 1 / (c · π^a e^b √2) = (1/2c) · π^-a e^-b √2
+            const Term& term = other.terms.front();
+            Basis inverse;
+            inverse.pi = static_cast<int8_t>(-term.basis.pi);
+            inverse.e = static_cast<int8_t>(-term.basis.e);
+            inverse.sqrt2 = term.basis.sqrt2;
+            Rational coeff = term.basis.sqrt2 ? (term.coeff * 2).inverse() : term.coeff.inverse();
+            if (term.basis.pi != INT8_MIN && term.basis.e != INT8_MIN) {
+                return times(NumberClass(0, inverse, std::move(coeff)));
+            }
+        }
+        size_t bits = precision();
+        if (bits == 0) {
+            double divisor = other.approximate();
+            if (divisor == 0) {
+                throw std::runtime_error("Division by zero");
+            }
+            return fallback(NumberClass(approximate() / divisor));
+        }
+        Rational divisor = other.approximate(bits + 8);
+        if (divisor.isZero()) {
+            throw std::runtime_error("Division by zero");
+        }
+        return fallback(NumberClass(rounded(approximate(bits + 8) / divisor, bits)));
+    }
+
+    // value approximated to precision(), or to a double when it is 0
+    static NumberClass fallback(NumberClass value) {
+        size_t bits = precision();
+        value.inexactBits = bits ? bits : std::numeric_limits<double>::digits;
+        return value;
+    }
+
+    // result with the precision of the least precise of it and the operands
+    NumberClass withOperands(NumberClass result, const NumberClass& other) const {
+        for (size_t bits : {inexactBits, other.inexactBits}) {
+            if (bits != 0 && (result.inexactBits == 0 || bits < result.inexactBits)) result.inexactBits = bits;
+        }
+        return result;
+    }
+
+public:
     // Convert to double for evaluation
     double approximate() const {
-        double rat = rationalPart.convert_to<double>();
-        double irr = 0;
-        switch (tag) {
-            case Tag::Pi:     irr = M_PI; break;
-            case Tag::E:      irr = M_E; break;
-            case Tag::Sqrt2:  irr = std::sqrt(2); break;
-            default:          irr = 0;
+        double value = rationalPart.toDouble();
+        for (const Term& term : terms) {
+            value += term.coeff.toDouble() * term.basis.approximate();
         }
-        return rat + (irr * irrationalPart.convert_to<double>());
+        return value;
     }
 
+    // The value to about bits significant bits, as an exact binary fraction.
+    // Terms that cancel lose relative precision, like in floating point.
+    Rational approximate(size_t bits) const;
+
     bool isPureRational() const {
-        return tag == Tag::None || irrationalPart == 0;
-    }
-
-    // Stream output
-    friend std::ostream& operator<<(std::ostream& os, const NumberClass& n) {
-        os << n.rationalPart.convert_to<double>();
-        if (n.tag != Tag::None && n.irrationalPart != 0) {
-            os << " + " << n.irrationalPart << "*";
-            switch (n.tag) {
-                case Tag::Pi: os << "π"; break;
-                case Tag::E: os << "e"; break;
-                case Tag::Sqrt2: os << "√2"; break;
-                default: os << "?";
-            }
-        }
-        return os;
+        return terms.empty();
     }
 
+    // Stream output, exact, see NumberFormat::number()
+    friend std::ostream& operator<<(std::ostream& os, const NumberClass& n);
+
     // Unary negation
     NumberClass operator-() const {
-        return NumberClass(-rationalPart, -irrationalPart, tag);
+        NumberClass out(-rationalPart);
+        out.inexactBits = inexactBits;
+        out.terms.reserve(terms.size());
+        for (const Term& term : terms) {
+            out.terms.push_back({term.basis, -term.coeff});
+        }
+        return out;
     }
 
     // Equality and inequality
     bool operator==(const NumberClass& other) const {
-        if (tag != other.tag) return false;
-        return rationalPart == other.rationalPart && irrationalPart == other.irrationalPart;
+        if (rationalPart != other.rationalPart || terms.size() != other.terms.size()) return false;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            if (!(terms[i].basis == other.terms[i].basis) || terms[i].coeff != other.terms[i].coeff) return false;
+        }
+        return true;
     }
 
     bool operator!=(const NumberClass& other) const {
         return !(*this == other);
     }
 
-    // Relational operators (approximate comparison)
+    // -1, 0 or 1, exact. A double estimate with an error bound decides
+    // most values, the rest are summed to more bits until it does.
+    int sign() const;
+
+    // Sign of *this - other, see sign()
+    int compare(const NumberClass& other) const {
+        if (terms.empty() && other.terms.empty()) {
+            if (rationalPart < other.rationalPart) return -1;
+            return other.rationalPart < rationalPart ? 1 : 0;
+        }
+        // No maxTerms() limit here, the difference is never rounded
+        NumberClass difference(rationalPart - other.rationalPart);
+        difference.terms = terms;
+        for (const Term& term : other.terms) {
+            difference.add(term.basis, -term.coeff);
+        }
+        return difference.sign();
+    }
+
+    // Relational operators (exact comparison)
     bool operator<(const NumberClass& other) const {
-        return this->approximate() < other.approximate();
+        return compare(other) < 0;
     }
 
     bool operator<=(const NumberClass& other) const {
-        return this->approximate() <= other.approximate();
+        return compare(other) <= 0;
     }
 
     bool operator>(const NumberClass& other) const {
-        return this->approximate() > other.approximate();
+        return compare(other) > 0;
     }
 
     bool operator>=(const NumberClass& other) const {
-        return this->approximate() >= other.approximate();
+        return compare(other) >= 0;
     }
 
     // Implicit conversion to bool for logical expressions
     explicit operator bool() const {
-        return rationalPart != 0 || irrationalPart != 0;
+        return !rationalPart.isZero() || !terms.empty();
+    }
+
+private:
+    static inline std::atomic<size_t> s_MaxTerms{8};
+    static inline std::atomic<size_t> s_Precision{0};
+
+    // value rounded to bits significant bits
+    static Rational rounded(const Rational& value, size_t bits);
+
+    static Basis constant(int8_t Basis::*exponent) {
+        Basis basis;
+        basis.*exponent = 1;
+        return basis;
+    }
+
+    // Product of two bases, folding √2·√2 = 2 into coeff. Empty if an
+    // exponent leaves the int8 range.
+    static std::optional<Basis> multiply(const Basis& a, const Basis& b, Rational& coeff) {
+        int pi = a.pi + b.pi;
+        int e = a.e + b.e;
+        if (pi < -127 || pi > 127 || e < -127 || e > 127) return std::nullopt;
+        Basis out;
+        out.pi = static_cast<int8_t>(pi);
+        out.e = static_cast<int8_t>(e);
+        out.sqrt2 = (a.sqrt2 + b.sqrt2) & 1;
+        if (a.sqrt2 && b.sqrt2) coeff *= 2;
+        return out;
+    }
+
+    // Adds coeff · basis, keeping terms sorted and free of zeros
+    void add(const Basis& basis, Rational coeff) {
+        if (coeff.isZero()) return;
+        if (basis.isOne()) {
+            rationalPart += coeff;
+            return;
+        }
+        auto it = std::lower_bound(terms.begin(), terms.end(), basis,
+                                   [](const Term& term, const Basis& b) { return term.basis < b; });
+        if (it != terms.end() && it->basis == basis) {
+            it->coeff += coeff;
+            if (it->coeff.isZero()) terms.erase(it);
+            return;
+        }
+        terms.insert(it, {basis, std::move(coeff)});
+    }
+
+    NumberClass scaled(const Rational& factor) const {
+        NumberClass out(rationalPart * factor);
+        out.inexactBits = inexactBits;
+        if (factor.isZero()) return out;
+        out.terms.reserve(terms.size());
+        for (const Term& term : terms) {
+            out.terms.push_back({term.basis, term.coeff * factor});
+        }
+        return out;
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,500 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           NumberFormat.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Exact radix formatting of rationals and Numbers
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "NumberFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+using boost::multiprecision::cpp_int;
+
+namespace
+{
+    const char digitChars[] = "0123456789ABCDEF";
+
+    // Below this many bits the schoolbook algorithms of cpp_int are faster
+    const size_t schoolbookBits = 4096;
+
+    size_t bitLength(const cpp_int &value)
+    {
+        return value == 0 ? 0 : boost::multiprecision::msb(value) + 1;
+    }
+
+    void checkRadix(unsigned radix)
+    {
+        if (radix != 2 && radix != 8 && radix != 10 && radix != 16)
+        {
+            throw std::invalid_argument("Unsupported radix " + std::to_string(radix));
+        }
+    }
+
+    const char *prefix(unsigned radix)
+    {
+        switch (radix)
+        {
+        case 2:
+            return "0b";
+        case 8:
+            return "0o";
+        case 16:
+            return "0x";
+        default:
+            return "";
+        }
+    }
+
+    // Bits per digit of a power of two radix, 0 for 10
+    unsigned digitBits(unsigned radix)
+    {
+        switch (radix)
+        {
+        case 2:
+            return 1;
+        case 8:
+            return 3;
+        case 16:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    // Power of two radixes read the digits straight from the bits, in linear time
+    void appendBits(const cpp_int &value, unsigned bits, std::string &out)
+    {
+        std::vector<unsigned char> bytes;
+        boost::multiprecision::export_bits(value, std::back_inserter(bytes), 8);
+        size_t totalBits = bytes.size() * 8;
+        auto bit = [&](size_t index) { // from the least significant bit
+            size_t fromTop = totalBits - 1 - index;
+            return (bytes[fromTop / 8] >> (7 - fromTop % 8)) & 1;
+        };
+        size_t digits = (bitLength(value) + bits - 1) / bits;
+        for (size_t d = digits; d-- > 0;)
+        {
+            unsigned digit = 0;
+            for (unsigned b = bits; b-- > 0;)
+            {
+                size_t index = d * bits + b;
+                digit = digit << 1 | (index < totalBits ? bit(index) : 0);
+            }
+            out += digitChars[digit];
+        }
+    }
+
+    // floor(2^(2n) / d) for d of n bits, by Newton iteration on the top half
+    // of d, so it costs a few multiplications instead of a long division
+    cpp_int reciprocal(const cpp_int &d)
+    {
+        size_t n = bitLength(d);
+        if (n <= schoolbookBits)
+        {
+            return (cpp_int(1) << (2 * n)) / d;
+        }
+        size_t h = n / 2 + 1;
+        cpp_int r = reciprocal(d >> (n - h)) << (n - h);
+        cpp_int one = cpp_int(1) << (2 * n);
+        cpp_int e = one - d * r;
+        r += (r * e) >> (2 * n);
+        e = one - d * r;
+        while (e < 0)
+        {
+            --r;
+            e += d;
+        }
+        while (e >= d)
+        {
+            ++r;
+            e -= d;
+        }
+        return r;
+    }
+
+    // radix^(chunk * 2^i) and its reciprocal, for the divide and conquer split
+    struct Power
+    {
+        cpp_int value;
+        cpp_int reciprocal;
+        size_t bits;
+        size_t digits;
+    };
+
+    void appendDecimal(const cpp_int &value, const std::vector<Power> &powers, int level, size_t pad,
+                       std::string &out)
+    {
+        if (level < 0 || bitLength(value) <= schoolbookBits)
+        {
+            std::string digits = value.str();
+            if (digits.size() < pad)
+            {
+                out.append(pad - digits.size(), '0');
+            }
+            out += digits;
+            return;
+        }
+        const Power &power = powers[level];
+        if (value < power.value)
+        {
+            appendDecimal(value, powers, level - 1, pad, out);
+            return;
+        }
+        // value < power^2, so the quotient estimate is off by a few at most
+        cpp_int q = (value * power.reciprocal) >> (2 * power.bits);
+        cpp_int r = value - q * power.value;
+        while (r >= power.value)
+        {
+            r -= power.value;
+            ++q;
+        }
+        appendDecimal(q, powers, level - 1, pad > power.digits ? pad - power.digits : 0, out);
+        appendDecimal(r, powers, level - 1, power.digits, out);
+    }
+
+    // value >= 0, written with at least pad digits
+    void appendInteger(const cpp_int &value, unsigned radix, size_t pad, std::string &out)
+    {
+        if (unsigned bits = digitBits(radix))
+        {
+            std::string digits;
+            if (value != 0)
+            {
+                appendBits(value, bits, digits);
+            }
+            if (digits.size() < pad || digits.empty())
+            {
+                out.append(std::max<size_t>(pad, 1) - digits.size(), '0');
+            }
+            out += digits;
+            return;
+        }
+
+        size_t bits = bitLength(value);
+        std::vector<Power> powers;
+        if (bits > schoolbookBits)
+        {
+            // Squares of 10^19 until the largest is at least half as long as value
+            Power power;
+            power.value = cpp_int(10000000000000000000ull);
+            power.digits = 19;
+            while (true)
+            {
+                power.bits = bitLength(power.value);
+                if (power.bits > schoolbookBits)
+                {
+                    power.reciprocal = reciprocal(power.value);
+                    powers.push_back(power);
+                }
+                if (power.bits * 2 > bits)
+                {
+                    break;
+                }
+                power.value *= power.value;
+                power.digits *= 2;
+            }
+        }
+        appendDecimal(value, powers, static_cast<int>(powers.size()) - 1, pad, out);
+    }
+
+    cpp_int power(unsigned radix, size_t exponent)
+    {
+        return boost::multiprecision::pow(cpp_int(radix), static_cast<unsigned>(exponent));
+    }
+
+    // Digits before the period of a fraction with denominator den: the
+    // factors den shares with the radix need that many digits to clear
+    size_t preperiod(cpp_int den, unsigned radix)
+    {
+        size_t twos = boost::multiprecision::lsb(den);
+        if (radix != 10)
+        {
+            return (twos + digitBits(radix) - 1) / digitBits(radix);
+        }
+        size_t fives = 0;
+        while (den % 5 == 0)
+        {
+            den /= 5;
+            fives++;
+        }
+        return std::max(twos, fives);
+    }
+
+    unsigned nextDigit(uint64_t &rem, uint64_t den, unsigned radix)
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 scaled = static_cast<unsigned __int128>(rem) * radix;
+        rem = static_cast<uint64_t>(scaled % den);
+        return static_cast<unsigned>(scaled / den);
+#else
+        // rem * radix can overflow, add rem radix times modulo den instead
+        uint64_t scaled = 0;
+        unsigned digit = 0;
+        for (unsigned i = 0; i < radix; ++i)
+        {
+            if (scaled >= den - rem)
+            {
+                scaled -= den - rem;
+                digit++;
+            }
+            else
+            {
+                scaled += rem;
+            }
+        }
+        rem = scaled;
+        return digit;
+#endif
+    }
+
+    unsigned nextDigit(cpp_int &rem, const cpp_int &den, unsigned radix)
+    {
+        cpp_int digit;
+        boost::multiprecision::divide_qr(cpp_int(rem * radix), den, digit, rem);
+        return digit.convert_to<unsigned>();
+    }
+
+    // Long division of rem/den < 1, machine words when den is below 2^64.
+    // The period is found by the remainder returning to its value at the
+    // start of the period. Returns false when it takes over maxDigits, which
+    // do not count leading zeros when the value is below one.
+    template <typename Int>
+    bool appendFraction(Int rem, const Int &den, unsigned radix, size_t periodStart, size_t maxDigits,
+                        bool belowOne, std::string &out)
+    {
+        std::string digits;
+        size_t significant = 0;
+        Int periodRem = 0;
+        for (size_t i = 0;; ++i)
+        {
+            if (i == periodStart)
+            {
+                periodRem = rem;
+            }
+            else if (i > periodStart && rem == periodRem)
+            {
+                out += digits.substr(0, periodStart) + "(" + digits.substr(periodStart) + ")";
+                return true;
+            }
+            if (rem == 0)
+            {
+                out += digits;
+                return true;
+            }
+            if (significant == maxDigits)
+            {
+                return false;
+            }
+            unsigned digit = nextDigit(rem, den, radix);
+            digits += digitChars[digit];
+            if (digit != 0 || significant != 0 || !belowOne)
+            {
+                significant++;
+            }
+        }
+    }
+
+    // An approximation to bits significant bits, without the digits below
+    // them: 1/(1+π) from doubles is 0.241453007005224..., not 20 digits of noise
+    std::string approximation(const Rational &value, size_t bits, const FormatOptions &options)
+    {
+        const unsigned radix = options.radix;
+        size_t significant = std::max<size_t>(1, static_cast<size_t>(bits * std::log(2.0) / std::log(radix)));
+        Rational::Big big = value.toBig();
+        cpp_int num = boost::multiprecision::abs(boost::multiprecision::numerator(big));
+        cpp_int den = boost::multiprecision::denominator(big);
+        cpp_int whole = num / den;
+        std::string wholeDigits;
+        if (whole != 0)
+        {
+            appendInteger(whole, radix, 0, wholeDigits);
+        }
+        if (wholeDigits.size() < significant)
+        {
+            FormatOptions fewer = options;
+            fewer.maxDigits = std::min(options.maxDigits, significant - wholeDigits.size());
+            return NumberFormat::rational(value, fewer);
+        }
+
+        // Round the integer part to the significant digits
+        cpp_int scale = power(radix, wholeDigits.size() - significant);
+        cpp_int rounded = (2 * num + den * scale) / (2 * den * scale) * scale;
+        std::string out = value.sign() < 0 ? "-" : "";
+        out += prefix(radix);
+        appendInteger(rounded, radix, 0, out);
+        return rounded * den == num ? out : out + "...";
+    }
+}
+
+namespace NumberFormat
+{
+    std::string integer(const cpp_int &value, unsigned radix)
+    {
+        checkRadix(radix);
+        std::string out;
+        if (value < 0)
+        {
+            out += '-';
+        }
+        out += prefix(radix);
+        appendInteger(boost::multiprecision::abs(value), radix, 0, out);
+        return out;
+    }
+
+    std::string rational(const Rational &value, const FormatOptions &options)
+    {
+        checkRadix(options.radix);
+        const unsigned radix = options.radix;
+        cpp_int num, den;
+        if (value.isSmall())
+        {
+            num = value.smallNumerator();
+            den = value.smallDenominator();
+        }
+        else
+        {
+            Rational::Big big = value.toBig();
+            num = boost::multiprecision::numerator(big);
+            den = boost::multiprecision::denominator(big);
+        }
+
+        std::string sign = num < 0 ? "-" : "";
+        num = boost::multiprecision::abs(num);
+        if (den == 1)
+        {
+            std::string out = sign + prefix(radix);
+            appendInteger(num, radix, 0, out);
+            return out;
+        }
+
+        cpp_int whole, rem;
+        boost::multiprecision::divide_qr(num, den, whole, rem);
+        size_t start = preperiod(den, radix);
+
+        std::string out = sign + prefix(radix);
+        std::string fraction;
+        bool exact = value.isSmall() ? appendFraction<uint64_t>(rem.convert_to<uint64_t>(), den.convert_to<uint64_t>(),
+                                                                 radix, start, options.maxDigits, whole == 0, fraction)
+                                     : appendFraction<cpp_int>(rem, den, radix, start, options.maxDigits, whole == 0,
+                                                               fraction);
+        if (exact)
+        {
+            appendInteger(whole, radix, 0, out);
+            return out + "." + fraction;
+        }
+
+        // Round to maxDigits, after the leading zeros of a value below one
+        size_t zeros = 0;
+        if (whole == 0)
+        {
+            cpp_int scaled = rem * radix;
+            while (scaled < den)
+            {
+                scaled *= radix;
+                zeros++;
+            }
+        }
+        size_t digits = zeros + options.maxDigits;
+        cpp_int scale = power(radix, digits);
+        cpp_int rounded = (2 * num * scale + den) / (2 * den);
+        boost::multiprecision::divide_qr(rounded, scale, whole, rem);
+        appendInteger(whole, radix, 0, out);
+        fraction.clear();
+        appendInteger(rem, radix, digits, fraction);
+        while (!fraction.empty() && fraction.back() == '0')
+        {
+            fraction.pop_back();
+        }
+        if (!fraction.empty())
+        {
+            out += "." + fraction;
+        }
+        return out + "...";
+    }
+
+    std::string number(const Number &value, const FormatOptions &options)
+    {
+        auto format = [&](const Rational &part) {
+            return value.inexactBits ? approximation(part, value.inexactBits, options) : rational(part, options);
+        };
+        if (value.terms.empty())
+        {
+            return format(value.rationalPart);
+        }
+
+        std::string out;
+        if (!value.rationalPart.isZero())
+        {
+            out = format(value.rationalPart);
+        }
+        for (const Number::Term &term : value.terms)
+        {
+            bool negative = term.coeff.sign() < 0;
+            if (out.empty())
+            {
+                out = negative ? "-" : "";
+            }
+            else
+            {
+                out += negative ? " - " : " + ";
+            }
+            Rational coeff = negative ? -term.coeff : term.coeff;
+            bool first = true;
+            if (coeff != Rational(1))
+            {
+                out += format(coeff);
+                first = false;
+            }
+            auto factor = [&](const char *name, int exponent) {
+                if (exponent == 0)
+                {
+                    return;
+                }
+                out += first ? "" : "*";
+                out += name;
+                if (exponent != 1)
+                {
+                    out += "^" + std::to_string(exponent);
+                }
+                first = false;
+            };
+            factor("π", term.basis.pi);
+            factor("e", term.basis.e);
+            factor("√2", term.basis.sqrt2);
+        }
+        return out;
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, const NumberClass &n)
+{
+    return os << NumberFormat::number(n);
+}
@@ -0,0 +1,59 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           NumberFormat.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Exact radix formatting of rationals and Numbers
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _NUMBER_FORMAT_H_
+#define _NUMBER_FORMAT_H_
+
+#include <cstddef>
+#include <string>
+#include "Number.h"
+
+struct FormatOptions
+{
+    unsigned radix = 10; // 2, 8, 10 or 16, the others are prefixed 0b, 0o, 0x
+    // Fraction digits shown, not counting the zeros right after the point of
+    // a value below one. Longer fractions are rounded and end in "...".
+    size_t maxDigits = 20;
+};
+
+// Exact conversion of values to text. Integers are always written in full,
+// with divide and conquer conversion so even million digit results take
+// subquadratic time. Fractions are written exactly when they terminate or
+// repeat within maxDigits, repeating digits in parentheses: 1/6 = 0.1(6).
+namespace NumberFormat
+{
+    std::string integer(const boost::multiprecision::cpp_int &value, unsigned radix = 10);
+    std::string rational(const Rational &value, const FormatOptions &options = FormatOptions());
+    // Rational part and symbolic terms, e.g. "1 + 2*π^2"
+    std::string number(const Number &value, const FormatOptions &options = FormatOptions());
+}
+
+#endif
@@ -0,0 +1,279 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           NumberLiteral.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Exact parsing of number literals
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "NumberLiteral.h"
+#include <cstdint>
+
+using boost::multiprecision::cpp_int;
+
+namespace
+{
+    // 19 decimal digits always fit in a uint64
+    const size_t chunkDigits = 19;
+    const uint64_t chunkScale = 10000000000000000000ull;
+
+    // Longer digit runs are split in halves, so the products stay balanced
+    // and the cpp_int multiplication can use Karatsuba
+    const size_t splitDigits = 1000;
+
+    bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    const char *skipDigits(const char *first, const char *last)
+    {
+        while (first != last && isDigit(*first))
+        {
+            ++first;
+        }
+        return first;
+    }
+
+    // Value of the decimal digits [first, last)
+    cpp_int decimal(const char *first, const char *last)
+    {
+        size_t count = static_cast<size_t>(last - first);
+        if (count > splitDigits)
+        {
+            const char *middle = first + count / 2;
+            return decimal(first, middle) * boost::multiprecision::pow(cpp_int(10), static_cast<unsigned>(last - middle)) +
+                   decimal(middle, last);
+        }
+        cpp_int out;
+        uint64_t chunk = 0;
+        size_t digits = 0;
+        for (; first != last; ++first)
+        {
+            chunk = chunk * 10 + static_cast<uint64_t>(*first - '0');
+            if (++digits == chunkDigits)
+            {
+                out = out * chunkScale + chunk;
+                chunk = 0;
+                digits = 0;
+            }
+        }
+        uint64_t scale = 1;
+        for (size_t i = 0; i < digits; ++i)
+        {
+            scale *= 10;
+        }
+        return out * scale + chunk;
+    }
+
+    // Value of the digits [first, last) in radix 2 or 16
+    cpp_int power2(const char *first, const char *last, unsigned bitsPerDigit)
+    {
+        cpp_int out;
+        uint64_t chunk = 0;
+        unsigned bits = 0;
+        for (; first != last; ++first)
+        {
+            chunk = chunk << bitsPerDigit | static_cast<uint64_t>(hexValue(*first));
+            bits += bitsPerDigit;
+            if (bits == 60)
+            {
+                out = out << 60 | chunk;
+                chunk = 0;
+                bits = 0;
+            }
+        }
+        return out << bits | chunk;
+    }
+
+    // f/F only after decimals, in 0x1f it is a digit
+    const char *skipSuffix(const char *first, const char *last, bool decimal)
+    {
+        while (first != last && (*first == 'u' || *first == 'U' || *first == 'l' || *first == 'L' ||
+                                 (decimal && (*first == 'f' || *first == 'F'))))
+        {
+            ++first;
+        }
+        return first;
+    }
+
+    std::from_chars_result radixLiteral(const char *first, const char *last, unsigned bitsPerDigit, Rational &value)
+    {
+        const char *end = first;
+        while (end != last && hexValue(*end) >= 0 && hexValue(*end) < (1 << bitsPerDigit))
+        {
+            ++end;
+        }
+        if (end == first)
+        {
+            return {first, std::errc::invalid_argument};
+        }
+        // Up to 60 bits stay in the int64 of a small Rational
+        if (static_cast<size_t>(end - first) * bitsPerDigit <= 60)
+        {
+            int64_t small = 0;
+            for (const char *p = first; p != end; ++p)
+            {
+                small = small << bitsPerDigit | hexValue(*p);
+            }
+            value = Rational(static_cast<long long>(small));
+        }
+        else
+        {
+            value = Rational(power2(first, end, bitsPerDigit));
+        }
+        return {skipSuffix(end, last, false), std::errc()};
+    }
+}
+
+std::from_chars_result NumberLiteral::parse(const char *first, const char *last, Rational &value)
+{
+    if (last - first > 2 && first[0] == '0')
+    {
+        if (first[1] == 'x' || first[1] == 'X')
+        {
+            std::from_chars_result result = radixLiteral(first + 2, last, 4, value);
+            if (result.ec == std::errc())
+            {
+                return result;
+            }
+        }
+        else if (first[1] == 'b' || first[1] == 'B')
+        {
+            std::from_chars_result result = radixLiteral(first + 2, last, 1, value);
+            if (result.ec == std::errc())
+            {
+                return result;
+            }
+        }
+        // Without digits after the prefix the literal is just the 0
+    }
+
+    // digits [. digits] [e [+-] digits], at least one digit in the mantissa
+    const char *integerEnd = skipDigits(first, last);
+    const char *fractionBegin = integerEnd;
+    const char *fractionEnd = integerEnd;
+    if (integerEnd != last && *integerEnd == '.')
+    {
+        fractionBegin = integerEnd + 1;
+        fractionEnd = skipDigits(fractionBegin, last);
+    }
+    if (integerEnd == first && fractionEnd == fractionBegin)
+    {
+        return {first, std::errc::invalid_argument};
+    }
+    const char *end = fractionEnd;
+
+    long exponent = 0;
+    bool outOfRange = false;
+    if (end != last && (*end == 'e' || *end == 'E'))
+    {
+        const char *p = end + 1;
+        bool negative = p != last && *p == '-';
+        if (p != last && (*p == '+' || *p == '-'))
+        {
+            ++p;
+        }
+        const char *digitsEnd = skipDigits(p, last);
+        // An e without digits is not part of the literal
+        if (digitsEnd != p)
+        {
+            for (; p != digitsEnd; ++p)
+            {
+                exponent = exponent * 10 + (*p - '0');
+                if (exponent > maxExponent)
+                {
+                    outOfRange = true;
+                    exponent = maxExponent;
+                }
+            }
+            exponent = negative ? -exponent : exponent;
+            end = digitsEnd;
+        }
+    }
+    end = skipSuffix(end, last, true);
+    if (outOfRange)
+    {
+        return {end, std::errc::result_out_of_range};
+    }
+
+    // value = mantissa * 10^scale
+    long scale = exponent - static_cast<long>(fractionEnd - fractionBegin);
+    size_t digits = static_cast<size_t>((integerEnd - first) + (fractionEnd - fractionBegin));
+    if (digits <= 18 && scale > -19 && scale < 19)
+    {
+        int64_t mantissa = 0;
+        for (const char *p = first; p != fractionEnd; ++p)
+        {
+            if (p != integerEnd)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+            }
+        }
+        int64_t power = 1;
+        for (long i = 0; i < (scale < 0 ? -scale : scale); ++i)
+        {
+            power *= 10;
+        }
+        // 1.5e3 fits, 12e17 does not
+        if (scale <= 0)
+        {
+            value = Rational::fraction(mantissa, power);
+            return {end, std::errc()};
+        }
+        if (mantissa <= INT64_MAX / power)
+        {
+            value = Rational(static_cast<long long>(mantissa * power));
+            return {end, std::errc()};
+        }
+    }
+
+    cpp_int mantissa = decimal(first, integerEnd);
+    if (fractionEnd != fractionBegin)
+    {
+        mantissa = mantissa * boost::multiprecision::pow(cpp_int(10), static_cast<unsigned>(fractionEnd - fractionBegin)) +
+                   decimal(fractionBegin, fractionEnd);
+    }
+    cpp_int power = boost::multiprecision::pow(cpp_int(10), static_cast<unsigned>(scale < 0 ? -scale : scale));
+    value = scale < 0 ? Rational(Rational::Big(mantissa, power)) : Rational(cpp_int(mantissa * power));
+    return {end, std::errc()};
+}
@@ -0,0 +1,55 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           NumberLiteral.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Exact parsing of number literals
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _NUMBER_LITERAL_H_
+#define _NUMBER_LITERAL_H_
+
+#include <charconv>
+#include "Rational.h"
+
+// Number literals as the tokenizer reads them: decimal with an optional
+// fraction and exponent (12, .5, 1.25e-3), hex (0x1F) and binary (0b101),
+// followed by any C style suffixes (u, l, and f after decimals, 1f or
+// 1.5f), which are skipped. Decimals and exponents give the exact
+// rational, 0.1 is 1/10.
+namespace NumberLiteral
+{
+    // Like std::from_chars: reads the longest literal at the start of
+    // [first, last) into value and returns the end of it. Never throws,
+    // ec is invalid_argument when there is no literal (value unchanged)
+    // and result_out_of_range when the exponent is past maxExponent.
+    std::from_chars_result parse(const char *first, const char *last, Rational &value);
+
+    // 10^100000 is already a third of a million bits
+    const long maxExponent = 100000;
+}
+
+#endif
@@ -0,0 +1,302 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Operators.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Operator descriptor table shared by the lexer, parser and evaluator
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _OPERATORS_H_
+#define _OPERATORS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+enum class OpCode : uint8_t
+{
+    NONE, // operator has no instruction, never emitted
+    PUSH_CONST,
+    LOAD_VAR,
+    STORE_VAR,
+    LOAD_TEMP,
+    STORE_TEMP,
+    NEG,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    AND,
+    OR,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE
+};
+
+enum class OperatorKind : uint8_t
+{
+    NONE, // not an operator, or a character no operator starts with
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    SHIFT_LEFT,
+    SHIFT_RIGHT,
+    LESS,
+    GREATER,
+    LESS_EQUAL,
+    GREATER_EQUAL,
+    EQUAL,
+    NOT_EQUAL,
+    BIT_AND,
+    BIT_XOR,
+    BIT_OR,
+    LOGICAL_AND,
+    LOGICAL_OR,
+    LOGICAL_NOT,
+    BIT_NOT,
+    QUESTION,
+    COLON,
+    ASSIGN,
+    ADD_ASSIGN,
+    SUB_ASSIGN,
+    MUL_ASSIGN,
+    DIV_ASSIGN,
+    MOD_ASSIGN,
+    SHIFT_LEFT_ASSIGN,
+    SHIFT_RIGHT_ASSIGN,
+    AND_ASSIGN,
+    XOR_ASSIGN,
+    OR_ASSIGN,
+    COMMA,
+    ARROW,
+    LEFT_PAREN,
+    RIGHT_PAREN,
+    COUNT
+};
+
+enum class Associativity : uint8_t
+{
+    LEFT,
+    RIGHT
+};
+
+// Arity bit mask, an operator like '-' is both
+enum OperatorArity : uint8_t
+{
+    ARITY_NONE = 0,
+    ARITY_UNARY = 1,
+    ARITY_BINARY = 2
+};
+
+struct OperatorInfo
+{
+    OperatorKind kind;
+    std::string_view symbol;
+    uint8_t precedence; // binary precedence, 0 if the operator never binds
+    Associativity associativity;
+    uint8_t arity;
+    OpCode binaryOp; // instruction of the binary form, NONE if unsupported
+    OpCode unaryOp;  // instruction of the prefix form, NONE if unsupported
+    bool assignment; // stores into its left operand, compound ones apply binaryOp first
+};
+
+// Every prefix operator binds tighter than any binary one
+constexpr uint8_t unaryPrecedence = 16;
+
+// Indexed by OperatorKind
+constexpr OperatorInfo operatorTable[] = {
+    {OperatorKind::NONE,                 "",    0,  Associativity::LEFT,  ARITY_NONE,                 OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::ADD,                  "+",   13, Associativity::LEFT,  ARITY_UNARY | ARITY_BINARY, OpCode::ADD,  OpCode::NONE, false},
+    {OperatorKind::SUB,                  "-",   13, Associativity::LEFT,  ARITY_UNARY | ARITY_BINARY, OpCode::SUB,  OpCode::NEG, false},
+    {OperatorKind::MUL,                  "*",   14, Associativity::LEFT,  ARITY_UNARY | ARITY_BINARY, OpCode::MUL,  OpCode::NONE, false},
+    {OperatorKind::DIV,                  "/",   14, Associativity::LEFT,  ARITY_BINARY,               OpCode::DIV,  OpCode::NONE, false},
+    {OperatorKind::MOD,                  "%",   14, Associativity::LEFT,  ARITY_BINARY,               OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::SHIFT_LEFT,           "<<",  12, Associativity::LEFT,  ARITY_BINARY,               OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::SHIFT_RIGHT,          ">>",  12, Associativity::LEFT,  ARITY_BINARY,               OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::LESS,                 "<",   11, Associativity::LEFT,  ARITY_BINARY,               OpCode::LT,   OpCode::NONE, false},
+    {OperatorKind::GREATER,              ">",   11, Associativity::LEFT,  ARITY_BINARY,               OpCode::GT,   OpCode::NONE, false},
+    {OperatorKind::LESS_EQUAL,           "<=",  11, Associativity::LEFT,  ARITY_BINARY,               OpCode::LE,   OpCode::NONE, false},
+    {OperatorKind::GREATER_EQUAL,        ">=",  11, Associativity::LEFT,  ARITY_BINARY,               OpCode::GE,   OpCode::NONE, false},
+    {OperatorKind::EQUAL,                "==",  10, Associativity::LEFT,  ARITY_BINARY,               OpCode::EQ,   OpCode::NONE, false},
+    {OperatorKind::NOT_EQUAL,            "!=",  10, Associativity::LEFT,  ARITY_BINARY,               OpCode::NE,   OpCode::NONE, false},
+    {OperatorKind::BIT_AND,              "&",   9,  Associativity::LEFT,  ARITY_UNARY | ARITY_BINARY, OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::BIT_XOR,              "^",   8,  Associativity::LEFT,  ARITY_BINARY,               OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::BIT_OR,               "|",   7,  Associativity::LEFT,  ARITY_BINARY,               OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::LOGICAL_AND,          "&&",  6,  Associativity::LEFT,  ARITY_BINARY,               OpCode::AND,  OpCode::NONE, false},
+    {OperatorKind::LOGICAL_OR,           "||",  5,  Associativity::LEFT,  ARITY_BINARY,               OpCode::OR,   OpCode::NONE, false},
+    {OperatorKind::LOGICAL_NOT,          "!",   0,  Associativity::LEFT,  ARITY_UNARY,                OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::BIT_NOT,              "~",   0,  Associativity::LEFT,  ARITY_UNARY,                OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::QUESTION,             "?",   4,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::COLON,                ":",   4,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::ASSIGN,               "=",   3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, true},
+    {OperatorKind::ADD_ASSIGN,           "+=",  3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::ADD,  OpCode::NONE, true},
+    {OperatorKind::SUB_ASSIGN,           "-=",  3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::SUB,  OpCode::NONE, true},
+    {OperatorKind::MUL_ASSIGN,           "*=",  3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::MUL,  OpCode::NONE, true},
+    {OperatorKind::DIV_ASSIGN,           "/=",  3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::DIV,  OpCode::NONE, true},
+    {OperatorKind::MOD_ASSIGN,           "%=",  3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, true},
+    {OperatorKind::SHIFT_LEFT_ASSIGN,    "<<=", 3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, true},
+    {OperatorKind::SHIFT_RIGHT_ASSIGN,   ">>=", 3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, true},
+    {OperatorKind::AND_ASSIGN,           "&=",  3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, true},
+    {OperatorKind::XOR_ASSIGN,           "^=",  3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, true},
+    {OperatorKind::OR_ASSIGN,            "|=",  3,  Associativity::RIGHT, ARITY_BINARY,               OpCode::NONE, OpCode::NONE, true},
+    {OperatorKind::COMMA,                ",",   2,  Associativity::LEFT,  ARITY_BINARY,               OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::ARROW,                "->",  0,  Associativity::LEFT,  ARITY_NONE,                 OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::LEFT_PAREN,           "(",   0,  Associativity::LEFT,  ARITY_NONE,                 OpCode::NONE, OpCode::NONE, false},
+    {OperatorKind::RIGHT_PAREN,          ")",   0,  Associativity::LEFT,  ARITY_NONE,                 OpCode::NONE, OpCode::NONE, false},
+};
+
+constexpr const OperatorInfo &operatorInfo(OperatorKind op)
+{
+    return operatorTable[static_cast<size_t>(op)];
+}
+
+// Longest match of the operator starting at str[i], returns its length. The
+// switch is what the lexer runs, the table above is checked against it below.
+constexpr size_t matchOperator(std::string_view str, size_t i, OperatorKind &kind)
+{
+    char c = str[i];
+    char next = i + 1 < str.size() ? str[i + 1] : '\0';
+    char next2 = i + 2 < str.size() ? str[i + 2] : '\0';
+
+    switch (c)
+    {
+    case '+':
+        kind = next == '=' ? OperatorKind::ADD_ASSIGN : OperatorKind::ADD;
+        return next == '=' ? 2 : 1;
+    case '-':
+        if (next == '>')
+        {
+            kind = OperatorKind::ARROW;
+            return 2;
+        }
+        kind = next == '=' ? OperatorKind::SUB_ASSIGN : OperatorKind::SUB;
+        return next == '=' ? 2 : 1;
+    case '*':
+        kind = next == '=' ? OperatorKind::MUL_ASSIGN : OperatorKind::MUL;
+        return next == '=' ? 2 : 1;
+    case '/':
+        kind = next == '=' ? OperatorKind::DIV_ASSIGN : OperatorKind::DIV;
+        return next == '=' ? 2 : 1;
+    case '%':
+        kind = next == '=' ? OperatorKind::MOD_ASSIGN : OperatorKind::MOD;
+        return next == '=' ? 2 : 1;
+    case '^':
+        kind = next == '=' ? OperatorKind::XOR_ASSIGN : OperatorKind::BIT_XOR;
+        return next == '=' ? 2 : 1;
+    case '=':
+        kind = next == '=' ? OperatorKind::EQUAL : OperatorKind::ASSIGN;
+        return next == '=' ? 2 : 1;
+    case '!':
+        kind = next == '=' ? OperatorKind::NOT_EQUAL : OperatorKind::LOGICAL_NOT;
+        return next == '=' ? 2 : 1;
+    case '&':
+        if (next == '&')
+        {
+            kind = OperatorKind::LOGICAL_AND;
+            return 2;
+        }
+        kind = next == '=' ? OperatorKind::AND_ASSIGN : OperatorKind::BIT_AND;
+        return next == '=' ? 2 : 1;
+    case '|':
+        if (next == '|')
+        {
+            kind = OperatorKind::LOGICAL_OR;
+            return 2;
+        }
+        kind = next == '=' ? OperatorKind::OR_ASSIGN : OperatorKind::BIT_OR;
+        return next == '=' ? 2 : 1;
+    case '<':
+        if (next == '<')
+        {
+            kind = next2 == '=' ? OperatorKind::SHIFT_LEFT_ASSIGN : OperatorKind::SHIFT_LEFT;
+            return next2 == '=' ? 3 : 2;
+        }
+        kind = next == '=' ? OperatorKind::LESS_EQUAL : OperatorKind::LESS;
+        return next == '=' ? 2 : 1;
+    case '>':
+        if (next == '>')
+        {
+            kind = next2 == '=' ? OperatorKind::SHIFT_RIGHT_ASSIGN : OperatorKind::SHIFT_RIGHT;
+            return next2 == '=' ? 3 : 2;
+        }
+        kind = next == '=' ? OperatorKind::GREATER_EQUAL : OperatorKind::GREATER;
+        return next == '=' ? 2 : 1;
+    case '~':
+        kind = OperatorKind::BIT_NOT;
+        return 1;
+    case '?':
+        kind = OperatorKind::QUESTION;
+        return 1;
+    case ':':
+        kind = OperatorKind::COLON;
+        return 1;
+    case ',':
+        kind = OperatorKind::COMMA;
+        return 1;
+    case '(':
+        kind = OperatorKind::LEFT_PAREN;
+        return 1;
+    case ')':
+        kind = OperatorKind::RIGHT_PAREN;
+        return 1;
+    default:
+        kind = OperatorKind::NONE;
+        return 1;
+    }
+}
+
+constexpr bool operatorTableIsConsistent()
+{
+    for (size_t i = 0; i < static_cast<size_t>(OperatorKind::COUNT); ++i)
+    {
+        const OperatorInfo &info = operatorTable[i];
+        if (static_cast<size_t>(info.kind) != i)
+        {
+            return false;
+        }
+        if (info.symbol.empty())
+        {
+            continue;
+        }
+        OperatorKind lexed = OperatorKind::NONE;
+        if (matchOperator(info.symbol, 0, lexed) != info.symbol.size() || lexed != info.kind)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sizeof(operatorTable) / sizeof(operatorTable[0]) == static_cast<size_t>(OperatorKind::COUNT),
+              "operatorTable must have one entry per OperatorKind");
+static_assert(operatorTableIsConsistent(), "operatorTable is out of sync with OperatorKind or matchOperator");
+
+#endif
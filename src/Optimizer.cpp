@@ -0,0 +1,347 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Optimizer.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    AST optimization passes implementation
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "Optimizer.h"
+#include "Expression.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    // Appends node, read from in with children already remapped, to out
+    uint32_t copyNode(const ASTArena &in, const ASTNode &node, const std::vector<uint32_t> &remap, ASTArena &out)
+    {
+        switch (node.type)
+        {
+        case NodeType::LITERAL:
+            return out.addLiteral(in.literal(node));
+        case NodeType::VARIABLE:
+            return out.addVariable(node.lhs);
+        case NodeType::UNARY:
+            return out.addUnary(node.op, remap[node.lhs]);
+        default:
+            return out.addBinary(node.op, remap[node.lhs], remap[node.rhs]);
+        }
+    }
+
+    // Keeps only the nodes reachable from root and moves the result into ast
+    void compact(ASTArena &ast, ASTArena &built, uint32_t root)
+    {
+        std::vector<bool> live(root + 1, false);
+        live[root] = true;
+        for (uint32_t i = root + 1; i-- > 0;)
+        {
+            if (!live[i])
+            {
+                continue;
+            }
+            const ASTNode &node = built[i];
+            if (node.type == NodeType::UNARY || node.type == NodeType::BINARY)
+            {
+                live[node.lhs] = true;
+            }
+            if (node.type == NodeType::BINARY)
+            {
+                live[node.rhs] = true;
+            }
+        }
+
+        ASTArena out;
+        out.reserve(root + 1, root + 1);
+        std::vector<uint32_t> remap(root + 1);
+        for (uint32_t i = 0; i <= root; ++i)
+        {
+            if (live[i])
+            {
+                remap[i] = copyNode(built, built[i], remap, out);
+            }
+        }
+        ast = std::move(out);
+    }
+
+    bool isLiteral(const ASTArena &ast, uint32_t index, int value)
+    {
+        const ASTNode &node = ast[index];
+        if (node.type != NodeType::LITERAL)
+        {
+            return false;
+        }
+        // A folded approximation of 1 must still mark the result inexact
+        const Number &literal = ast.literal(node);
+        return literal.inexactBits == 0 && literal == Number(value);
+    }
+}
+
+namespace Optimizer
+{
+    OptimizerStats run(ASTArena &ast)
+    {
+        OptimizerStats stats;
+        stats.passes.push_back(foldConstants(ast));
+        stats.passes.push_back(simplify(ast));
+        stats.passes.push_back(shareSubtrees(ast));
+        return stats;
+    }
+
+    OptimizerPassStats foldConstants(ASTArena &ast)
+    {
+        OptimizerPassStats stats{"fold constants", ast.size(), 0, 0};
+        if (ast.empty())
+        {
+            return stats;
+        }
+        ASTArena out;
+        std::vector<uint32_t> remap(ast.size());
+
+        for (uint32_t i = 0; i < ast.size(); ++i)
+        {
+            const ASTNode &node = ast[i];
+            const OperatorInfo &info = operatorInfo(node.op);
+            bool foldable =
+                (node.type == NodeType::UNARY && out[remap[node.lhs]].type == NodeType::LITERAL) ||
+                (node.type == NodeType::BINARY && !info.assignment &&
+                 out[remap[node.lhs]].type == NodeType::LITERAL && out[remap[node.rhs]].type == NodeType::LITERAL);
+
+            if (foldable)
+            {
+                try
+                {
+                    Number value;
+                    if (node.type == NodeType::UNARY)
+                    {
+                        const Number &operand = out.literal(out[remap[node.lhs]]);
+                        value = node.op == OperatorKind::ADD ? operand : applyUnary(info.unaryOp, operand);
+                    }
+                    else
+                    {
+                        value = applyBinary(info.binaryOp, out.literal(out[remap[node.lhs]]),
+                                            out.literal(out[remap[node.rhs]]));
+                    }
+                    remap[i] = out.addLiteral(std::move(value));
+                    stats.rewrites++;
+                    continue;
+                }
+                catch (const std::exception &)
+                {
+                    // Unsupported operator or invalid operation, leave it to
+                    // fail the same way at evaluation time
+                }
+            }
+            remap[i] = copyNode(ast, node, remap, out);
+        }
+
+        compact(ast, out, remap[ast.root()]);
+        stats.nodesAfter = ast.size();
+        return stats;
+    }
+
+    OptimizerPassStats simplify(ASTArena &ast)
+    {
+        OptimizerPassStats stats{"simplify", ast.size(), 0, 0};
+        if (ast.empty())
+        {
+            return stats;
+        }
+        ASTArena out;
+        std::vector<uint32_t> remap(ast.size());
+
+        for (uint32_t i = 0; i < ast.size(); ++i)
+        {
+            const ASTNode &node = ast[i];
+            uint32_t replacement = UINT32_MAX;
+
+            if (node.type == NodeType::UNARY)
+            {
+                uint32_t operand = remap[node.lhs];
+                if (node.op == OperatorKind::ADD)
+                {
+                    replacement = operand;
+                }
+                else if (node.op == OperatorKind::SUB && out[operand].type == NodeType::UNARY &&
+                         out[operand].op == OperatorKind::SUB)
+                {
+                    replacement = out[operand].lhs;
+                }
+            }
+            else if (node.type == NodeType::BINARY)
+            {
+                uint32_t lhs = remap[node.lhs];
+                uint32_t rhs = remap[node.rhs];
+                switch (node.op)
+                {
+                case OperatorKind::MUL:
+                    replacement = isLiteral(out, rhs, 1) ? lhs : isLiteral(out, lhs, 1) ? rhs : UINT32_MAX;
+                    break;
+                case OperatorKind::DIV:
+                    replacement = isLiteral(out, rhs, 1) ? lhs : UINT32_MAX;
+                    break;
+                case OperatorKind::ADD:
+                    replacement = isLiteral(out, rhs, 0) ? lhs : isLiteral(out, lhs, 0) ? rhs : UINT32_MAX;
+                    break;
+                case OperatorKind::SUB:
+                    replacement = isLiteral(out, rhs, 0) ? lhs : UINT32_MAX;
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (replacement != UINT32_MAX)
+            {
+                remap[i] = replacement;
+                stats.rewrites++;
+            }
+            else
+            {
+                remap[i] = copyNode(ast, node, remap, out);
+            }
+        }
+
+        compact(ast, out, remap[ast.root()]);
+        stats.nodesAfter = ast.size();
+        return stats;
+    }
+
+    OptimizerPassStats shareSubtrees(ASTArena &ast)
+    {
+        OptimizerPassStats stats{"share subtrees", ast.size(), 0, 0};
+        if (ast.empty())
+        {
+            return stats;
+        }
+
+        // A variable assigned anywhere in the expression can hold different
+        // values at different reads
+        std::vector<bool> assigned;
+        for (uint32_t i = 0; i < ast.size(); ++i)
+        {
+            if (ast[i].type == NodeType::BINARY && operatorInfo(ast[i].op).assignment)
+            {
+                uint32_t slot = ast[ast[i].lhs].lhs;
+                assigned.resize(std::max<size_t>(assigned.size(), slot + 1), false);
+                assigned[slot] = true;
+            }
+        }
+
+        // Operator nodes are keyed on their already shared children, literals
+        // on their value
+        auto nodeKey = [](const ASTNode &node) {
+            uint64_t key = static_cast<uint64_t>(node.type) | static_cast<uint64_t>(node.op) << 8;
+            return key ^ (static_cast<uint64_t>(node.lhs) << 16) * 0x9E3779B97F4A7C15ull ^
+                   static_cast<uint64_t>(node.rhs) * 0xC2B2AE3D27D4EB4Full;
+        };
+        auto literalKey = [](const Number &value) {
+            double approx = value.approximate();
+            uint64_t bits;
+            std::memcpy(&bits, &approx, sizeof(bits));
+            return bits;
+        };
+
+        ASTArena out;
+        std::vector<uint32_t> remap(ast.size());
+        std::vector<bool> shareable(ast.size());
+        std::unordered_multimap<uint64_t, uint32_t> seen;
+
+        for (uint32_t i = 0; i < ast.size(); ++i)
+        {
+            const ASTNode &node = ast[i];
+            switch (node.type)
+            {
+            case NodeType::LITERAL:
+                shareable[i] = true;
+                break;
+            case NodeType::VARIABLE:
+                shareable[i] = node.lhs >= assigned.size() || !assigned[node.lhs];
+                break;
+            case NodeType::UNARY:
+                shareable[i] = shareable[node.lhs];
+                break;
+            case NodeType::BINARY:
+                shareable[i] = shareable[node.lhs] && shareable[node.rhs] && !operatorInfo(node.op).assignment;
+                break;
+            }
+            if (!shareable[i])
+            {
+                remap[i] = copyNode(ast, node, remap, out);
+                continue;
+            }
+
+            ASTNode mapped = node;
+            if (node.type == NodeType::UNARY || node.type == NodeType::BINARY)
+            {
+                mapped.lhs = remap[node.lhs];
+            }
+            if (node.type == NodeType::BINARY)
+            {
+                mapped.rhs = remap[node.rhs];
+            }
+            uint64_t key = node.type == NodeType::LITERAL ? literalKey(ast.literal(node)) : nodeKey(mapped);
+
+            uint32_t found = UINT32_MAX;
+            auto range = seen.equal_range(key);
+            for (auto it = range.first; it != range.second && found == UINT32_MAX; ++it)
+            {
+                const ASTNode &candidate = out[it->second];
+                if (candidate.type != mapped.type)
+                {
+                    continue;
+                }
+                if (mapped.type == NodeType::LITERAL)
+                {
+                    const Number &literal = ast.literal(node);
+                    if (out.literal(candidate) == literal && out.literal(candidate).inexactBits == literal.inexactBits)
+                    {
+                        found = it->second;
+                    }
+                }
+                else if (candidate.op == mapped.op && candidate.lhs == mapped.lhs && candidate.rhs == mapped.rhs)
+                {
+                    found = it->second;
+                }
+            }
+
+            if (found != UINT32_MAX)
+            {
+                remap[i] = found;
+                stats.rewrites++;
+            }
+            else
+            {
+                remap[i] = copyNode(ast, node, remap, out);
+                seen.emplace(key, remap[i]);
+            }
+        }
+
+        compact(ast, out, remap[ast.root()]);
+        stats.nodesAfter = ast.size();
+        return stats;
+    }
+}
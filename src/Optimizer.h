@@ -0,0 +1,83 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Optimizer.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    AST optimization passes
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _OPTIMIZER_H_
+#define _OPTIMIZER_H_
+
+#include <cstdint>
+#include <vector>
+
+class ASTArena;
+
+struct OptimizerPassStats
+{
+    const char *name;
+    uint32_t nodesBefore;
+    uint32_t nodesAfter;
+    uint32_t rewrites;
+};
+
+struct OptimizerStats
+{
+    std::vector<OptimizerPassStats> passes;
+
+    uint32_t nodesBefore() const
+    {
+        return passes.empty() ? 0 : passes.front().nodesBefore;
+    }
+    uint32_t nodesAfter() const
+    {
+        return passes.empty() ? 0 : passes.back().nodesAfter;
+    }
+};
+
+// Every pass rebuilds the arena in post-order and drops nodes no longer
+// reachable from the root, so the root stays the last node. Only
+// Expression::compile() runs the passes, the one-shot eval() path does not.
+namespace Optimizer
+{
+    // Runs foldConstants, simplify and shareSubtrees in that order
+    OptimizerStats run(ASTArena &ast);
+
+    // Replaces operators whose operands are all literals by their value,
+    // computed with the same Number arithmetic the evaluators use
+    OptimizerPassStats foldConstants(ASTArena &ast);
+
+    // x*1, 1*x, x/1, x+0, 0+x, x-0, +x and -(-x) become x
+    OptimizerPassStats simplify(ASTArena &ast);
+
+    // Hash-conses identical subtrees so each is stored and computed once,
+    // turning the tree into a DAG. Subtrees reading a variable the
+    // expression assigns to are left alone.
+    OptimizerPassStats shareSubtrees(ASTArena &ast);
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           PreviewEvaluator.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Debounced background evaluation of partial input
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "PreviewEvaluator.h"
+#include "NumberFormat.h"
+
+PreviewEvaluator::PreviewEvaluator(std::chrono::milliseconds debounce) : m_Debounce(debounce)
+{
+    m_Expression.setEnvironment(m_Env);
+    m_Expression.setCancelFlag(&m_Cancel);
+    m_Thread = std::thread([this]() { worker(); });
+}
+
+PreviewEvaluator::~PreviewEvaluator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Cancel = true;
+    m_Changed.notify_one();
+    m_Thread.join();
+}
+
+void PreviewEvaluator::submit(const std::string &text)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (text == m_Text)
+        {
+            return;
+        }
+        m_Text = text;
+        m_Generation++;
+        m_SubmitTime = std::chrono::steady_clock::now();
+        m_Result.clear();
+        // Set under the lock, so it cannot cancel the evaluation of this text
+        m_Cancel = true;
+    }
+    m_Changed.notify_one();
+}
+
+std::string PreviewEvaluator::result()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ResultGeneration == m_Generation ? m_Result : std::string();
+}
+
+void PreviewEvaluator::setResultCallback(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_ResultCallback = std::move(callback);
+}
+
+void PreviewEvaluator::setVariables(Environment variables)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Variables = std::move(variables);
+}
+
+void PreviewEvaluator::worker()
+{
+    uint64_t done = 0;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_Changed.wait(lock, [&]() { return m_Stop || m_Generation != done; });
+        if (m_Stop)
+        {
+            return;
+        }
+
+        // Wait for typing to pause, every submit() restarts the delay
+        auto deadline = m_SubmitTime + m_Debounce;
+        while (!m_Stop && std::chrono::steady_clock::now() < deadline)
+        {
+            m_Changed.wait_until(lock, deadline);
+            deadline = m_SubmitTime + m_Debounce;
+        }
+        if (m_Stop)
+        {
+            return;
+        }
+
+        uint64_t generation = m_Generation;
+        std::string text = m_Text;
+        m_Env = m_Variables;
+        m_Cancel = false;
+        lock.unlock();
+
+        std::string value;
+        if (!text.empty())
+        {
+            try
+            {
+                m_Expression.update(std::move(text));
+                value = NumberFormat::number(m_Expression.evaluate());
+            }
+            catch (const std::exception &)
+            {
+                // Incomplete or invalid input has no preview
+            }
+        }
+
+        lock.lock();
+        done = generation;
+        if (generation == m_Generation)
+        {
+            bool changed = !value.empty();
+            m_Result = std::move(value);
+            m_ResultGeneration = generation;
+            if (changed && m_ResultCallback)
+            {
+                std::function<void()> callback = m_ResultCallback;
+                lock.unlock();
+                callback();
+                lock.lock();
+            }
+        }
+    }
+}
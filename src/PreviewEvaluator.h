@@ -0,0 +1,94 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           PreviewEvaluator.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Debounced background evaluation of partial input
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _PREVIEW_EVALUATOR_H_
+#define _PREVIEW_EVALUATOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Expression.h"
+
+// Evaluates the input being typed on a worker thread, so the preview never
+// blocks a frame. A submit() cancels the evaluation in progress, and the
+// worker waits for the input to be unchanged for the debounce delay before
+// starting the next one. The preview sees the variables given to
+// setVariables(), assignments in the previewed text do not change them.
+class PreviewEvaluator
+{
+public:
+    explicit PreviewEvaluator(std::chrono::milliseconds debounce = std::chrono::milliseconds(120));
+    ~PreviewEvaluator();
+
+    PreviewEvaluator(const PreviewEvaluator &) = delete;
+    PreviewEvaluator &operator=(const PreviewEvaluator &) = delete;
+
+    // Cheap to call every frame, text equal to the last one is ignored
+    void submit(const std::string &text);
+
+    // Formatted result of the last submitted text, empty while it is being
+    // evaluated or when the text does not evaluate (e.g. it is incomplete)
+    std::string result();
+
+    // Variables of the session, e.g. AsyncEvaluator::variables(), used from
+    // the next evaluation on
+    void setVariables(Environment variables);
+
+    // Called on the worker thread whenever a new result is available, lets
+    // an idle UI wake up to show it
+    void setResultCallback(std::function<void()> callback);
+
+private:
+    void worker();
+
+    std::chrono::milliseconds m_Debounce;
+    std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+    std::string m_Text;     // last submitted text
+    uint64_t m_Generation = 0;
+    std::chrono::steady_clock::time_point m_SubmitTime;
+    std::string m_Result;
+    uint64_t m_ResultGeneration = 0;
+    std::function<void()> m_ResultCallback;
+    Environment m_Variables;
+    bool m_Stop = false;
+    std::atomic<bool> m_Cancel{false};
+    Expression m_Expression; // only used by the worker, kept to re-lex the tail
+    Environment m_Env;       // copy of m_Variables for one evaluation
+    std::thread m_Thread;
+};
+
+#endif
@@ -0,0 +1,441 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           Rational.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Exact rational with an inline int64 fast path
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _RATIONAL_H_
+#define _RATIONAL_H_
+
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Exact rational number. Values whose numerator and denominator fit in an
+// int64 are kept inline and computed with overflow checked machine
+// arithmetic, only results that overflow are promoted to a heap allocated
+// cpp_rational. Big results that fit again are demoted, so every value has
+// exactly one representation and comparing the representations is exact.
+class Rational
+{
+public:
+    using Big = boost::multiprecision::cpp_rational;
+
+    Rational() = default;
+    Rational(int value) : m_Num(value) {}
+    Rational(long value) { setInteger(static_cast<long long>(value)); }
+    Rational(long long value) { setInteger(value); }
+    Rational(double value) { set(Big(value)); }
+    Rational(const Big &value) { set(value); }
+    Rational(Big &&value) { set(std::move(value)); }
+    Rational(const boost::multiprecision::cpp_int &value) { set(Big(value)); }
+
+    // Throws on a zero denominator
+    static Rational fraction(int64_t num, int64_t den)
+    {
+        if (den == 0)
+        {
+            throw std::runtime_error("Division by zero");
+        }
+        if (num == MIN || den == MIN)
+        {
+            return Rational(Big(num, den));
+        }
+        Rational out;
+        out.setSmall(num, den);
+        return out;
+    }
+
+    bool isSmall() const
+    {
+        return !m_Big;
+    }
+    // Only valid for small values
+    int64_t smallNumerator() const
+    {
+        return m_Num;
+    }
+    int64_t smallDenominator() const
+    {
+        return m_Den;
+    }
+
+    Big toBig() const
+    {
+        return m_Big ? *m_Big : Big(m_Num, m_Den);
+    }
+
+    bool isZero() const
+    {
+        return !m_Big && m_Num == 0;
+    }
+    bool isInteger() const
+    {
+        return m_Big ? boost::multiprecision::denominator(*m_Big) == 1 : m_Den == 1;
+    }
+    int sign() const
+    {
+        if (m_Big)
+        {
+            return m_Big->sign();
+        }
+        return (m_Num > 0) - (m_Num < 0);
+    }
+
+    // Largest bit length of the numerator and the denominator
+    uint64_t bits() const
+    {
+        if (m_Big)
+        {
+            auto integerBits = [](const boost::multiprecision::cpp_int &n) -> uint64_t {
+                return n == 0 ? 0 : boost::multiprecision::msb(boost::multiprecision::abs(n)) + 1;
+            };
+            return std::max(integerBits(boost::multiprecision::numerator(*m_Big)),
+                            integerBits(boost::multiprecision::denominator(*m_Big)));
+        }
+        auto integerBits = [](uint64_t n) -> uint64_t {
+            uint64_t bits = 0;
+            for (; n; n >>= 1)
+            {
+                bits++;
+            }
+            return bits;
+        };
+        return std::max(integerBits(m_Num < 0 ? -static_cast<uint64_t>(m_Num) : m_Num), integerBits(m_Den));
+    }
+
+    // Heap bytes held by the value
+    size_t memoryUsage() const
+    {
+        if (!m_Big)
+        {
+            return 0;
+        }
+        auto limbs = [](const auto &n) { return n.backend().size() * sizeof(boost::multiprecision::limb_type); };
+        return sizeof(Big) + limbs(boost::multiprecision::numerator(*m_Big)) +
+               limbs(boost::multiprecision::denominator(*m_Big));
+    }
+
+    double toDouble() const
+    {
+        // Both operands exact in a double, so the quotient is correctly rounded
+        const int64_t exact = int64_t(1) << 53;
+        if (!m_Big && m_Num >= -exact && m_Num <= exact && m_Den <= exact)
+        {
+            return static_cast<double>(m_Num) / static_cast<double>(m_Den);
+        }
+        return toBig().convert_to<double>();
+    }
+
+    template <typename T>
+    T convert_to() const
+    {
+        if constexpr (std::is_same_v<T, double>)
+        {
+            return toDouble();
+        }
+        else
+        {
+            return toBig().template convert_to<T>();
+        }
+    }
+
+    Rational operator-() const
+    {
+        if (m_Big)
+        {
+            return Rational(Big(-*m_Big));
+        }
+        Rational out;
+        out.m_Num = -m_Num;
+        out.m_Den = m_Den;
+        return out;
+    }
+
+    friend Rational operator+(const Rational &a, const Rational &b)
+    {
+        if (!a.m_Big && !b.m_Big)
+        {
+            int64_t num;
+            if (a.m_Den == 1 && b.m_Den == 1 && !add(a.m_Num, b.m_Num, num))
+            {
+                Rational out;
+                out.m_Num = num;
+                return out;
+            }
+            // a/b + c/d = (a*(d/g) + c*(b/g)) / (b/g*d), g = gcd(b, d)
+            int64_t g = std::gcd(a.m_Den, b.m_Den);
+            int64_t left, right, den;
+            if (!mul(a.m_Num, b.m_Den / g, left) && !mul(b.m_Num, a.m_Den / g, right) && !add(left, right, num) &&
+                !mul(a.m_Den / g, b.m_Den, den))
+            {
+                Rational out;
+                out.setReduced(num, den, g);
+                return out;
+            }
+        }
+        return Rational(a.toBig() + b.toBig());
+    }
+
+    friend Rational operator-(const Rational &a, const Rational &b)
+    {
+        return a + (-b);
+    }
+
+    friend Rational operator*(const Rational &a, const Rational &b)
+    {
+        if (!a.m_Big && !b.m_Big)
+        {
+            // Cancel crosswise first, the result is then already reduced
+            int64_t g1 = std::gcd(a.m_Num, b.m_Den);
+            int64_t g2 = std::gcd(b.m_Num, a.m_Den);
+            if (g1 == 0 || g2 == 0)
+            {
+                return Rational();
+            }
+            int64_t num, den;
+            if (!mul(a.m_Num / g1, b.m_Num / g2, num) && !mul(a.m_Den / g2, b.m_Den / g1, den))
+            {
+                Rational out;
+                out.m_Num = num;
+                out.m_Den = den;
+                return out;
+            }
+        }
+        return Rational(a.toBig() * b.toBig());
+    }
+
+    // Throws on division by zero
+    friend Rational operator/(const Rational &a, const Rational &b)
+    {
+        if (b.isZero())
+        {
+            throw std::runtime_error("Division by zero");
+        }
+        return a * b.inverse();
+    }
+
+    Rational inverse() const
+    {
+        if (isZero())
+        {
+            throw std::runtime_error("Division by zero");
+        }
+        if (m_Big)
+        {
+            return Rational(Big(1) / *m_Big);
+        }
+        Rational out;
+        out.m_Num = m_Num < 0 ? -m_Den : m_Den;
+        out.m_Den = m_Num < 0 ? -m_Num : m_Num;
+        return out;
+    }
+
+    Rational &operator+=(const Rational &other)
+    {
+        return *this = *this + other;
+    }
+    Rational &operator-=(const Rational &other)
+    {
+        return *this = *this - other;
+    }
+    Rational &operator*=(const Rational &other)
+    {
+        return *this = *this * other;
+    }
+    Rational &operator/=(const Rational &other)
+    {
+        return *this = *this / other;
+    }
+
+    friend bool operator==(const Rational &a, const Rational &b)
+    {
+        if (!a.m_Big && !b.m_Big)
+        {
+            return a.m_Num == b.m_Num && a.m_Den == b.m_Den;
+        }
+        // Values that fit are always small, so a small and a big one differ
+        return a.m_Big && b.m_Big && *a.m_Big == *b.m_Big;
+    }
+    friend bool operator!=(const Rational &a, const Rational &b)
+    {
+        return !(a == b);
+    }
+
+    friend bool operator<(const Rational &a, const Rational &b)
+    {
+        if (!a.m_Big && !b.m_Big)
+        {
+            int64_t left, right;
+            if (!mul(a.m_Num, b.m_Den, left) && !mul(b.m_Num, a.m_Den, right))
+            {
+                return left < right;
+            }
+        }
+        return a.toBig() < b.toBig();
+    }
+    friend bool operator>(const Rational &a, const Rational &b)
+    {
+        return b < a;
+    }
+    friend bool operator<=(const Rational &a, const Rational &b)
+    {
+        return !(b < a);
+    }
+    friend bool operator>=(const Rational &a, const Rational &b)
+    {
+        return !(a < b);
+    }
+
+    // Same text as cpp_rational: "3", "-1/3"
+    friend std::ostream &operator<<(std::ostream &os, const Rational &value)
+    {
+        if (value.m_Big)
+        {
+            return os << *value.m_Big;
+        }
+        os << value.m_Num;
+        if (value.m_Den != 1)
+        {
+            os << '/' << value.m_Den;
+        }
+        return os;
+    }
+
+private:
+    // INT64_MIN is never stored, so negation cannot overflow
+    static constexpr int64_t MIN = std::numeric_limits<int64_t>::min();
+
+    // Return true on overflow
+    static bool add(int64_t a, int64_t b, int64_t &out)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_add_overflow(a, b, &out) || out == MIN;
+#else
+        if ((b > 0 && a > std::numeric_limits<int64_t>::max() - b) || (b < 0 && a < MIN + 1 - b))
+        {
+            return true;
+        }
+        out = a + b;
+        return false;
+#endif
+    }
+
+    static bool mul(int64_t a, int64_t b, int64_t &out)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_mul_overflow(a, b, &out) || out == MIN;
+#else
+        if (a != 0 && b != 0)
+        {
+            int64_t max = std::numeric_limits<int64_t>::max();
+            uint64_t ua = a < 0 ? -static_cast<uint64_t>(a) : a;
+            uint64_t ub = b < 0 ? -static_cast<uint64_t>(b) : b;
+            if (ua > static_cast<uint64_t>(max) / ub)
+            {
+                return true;
+            }
+        }
+        out = a * b;
+        return false;
+#endif
+    }
+
+    void setInteger(long long value)
+    {
+        if (value == MIN)
+        {
+            set(Big(value));
+            return;
+        }
+        m_Num = value;
+    }
+
+    // num/den with den != 0, neither INT64_MIN
+    void setSmall(int64_t num, int64_t den)
+    {
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+        int64_t g = std::gcd(num, den);
+        m_Num = num / g;
+        m_Den = den / g;
+    }
+
+    // num/den where only a factor of hint can be shared, den > 0
+    void setReduced(int64_t num, int64_t den, int64_t hint)
+    {
+        int64_t g = std::gcd(num, hint);
+        if (g > 1)
+        {
+            num /= g;
+            den /= g;
+        }
+        if (num == 0)
+        {
+            den = 1;
+        }
+        m_Num = num;
+        m_Den = den;
+    }
+
+    template <typename B>
+    void set(B &&value)
+    {
+        using boost::multiprecision::denominator;
+        using boost::multiprecision::numerator;
+        const auto &num = numerator(value);
+        const auto &den = denominator(value);
+        const int64_t max = std::numeric_limits<int64_t>::max();
+        if (num <= max && num >= -max && den <= max)
+        {
+            m_Num = num.template convert_to<int64_t>();
+            m_Den = den.template convert_to<int64_t>();
+            m_Big.reset();
+            return;
+        }
+        m_Num = 0;
+        m_Den = 1;
+        m_Big = std::make_shared<const Big>(std::forward<B>(value));
+    }
+
+    int64_t m_Num = 0;
+    int64_t m_Den = 1; // always positive, gcd(m_Num, m_Den) == 1
+    // Shared and never modified, copying a big value does not copy its limbs
+    std::shared_ptr<const Big> m_Big;
+};
+
+#endif
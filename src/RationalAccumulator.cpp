@@ -0,0 +1,159 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           RationalAccumulator.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Sums and products of many rationals with deferred reduction
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include "RationalAccumulator.h"
+#include <algorithm>
+
+namespace
+{
+    // Bits of the numerator or denominator before the first reduction
+    const size_t initialLimit = 2048;
+
+    size_t bitLength(const boost::multiprecision::cpp_int &value)
+    {
+        return value == 0 ? 0 : boost::multiprecision::msb(boost::multiprecision::abs(value)) + 1;
+    }
+
+    void parts(const Rational &value, boost::multiprecision::cpp_int &num, boost::multiprecision::cpp_int &den)
+    {
+        if (value.isSmall())
+        {
+            num = value.smallNumerator();
+            den = value.smallDenominator();
+        }
+        else
+        {
+            Rational::Big big = value.toBig();
+            num = boost::multiprecision::numerator(big);
+            den = boost::multiprecision::denominator(big);
+        }
+    }
+}
+
+void RationalAccumulator::add(const Rational &value)
+{
+    if (!m_Deferred)
+    {
+        if (m_Small.isSmall() && value.isSmall())
+        {
+            Rational sum = m_Small + value;
+            if (sum.isSmall())
+            {
+                m_Small = std::move(sum);
+                return;
+            }
+        }
+        defer();
+    }
+    Int num, den;
+    parts(value, num, den);
+    addParts(num, den);
+}
+
+void RationalAccumulator::subtract(const Rational &value)
+{
+    add(-value);
+}
+
+void RationalAccumulator::multiply(const Rational &value)
+{
+    if (!m_Deferred)
+    {
+        if (m_Small.isSmall() && value.isSmall())
+        {
+            Rational product = m_Small * value;
+            if (product.isSmall())
+            {
+                m_Small = std::move(product);
+                return;
+            }
+        }
+        defer();
+    }
+    Int num, den;
+    parts(value, num, den);
+    multiplyParts(num, den);
+}
+
+void RationalAccumulator::divide(const Rational &value)
+{
+    multiply(value.inverse());
+}
+
+Rational RationalAccumulator::result() const
+{
+    if (!m_Deferred)
+    {
+        return m_Small;
+    }
+    // The cpp_rational constructor reduces
+    return Rational(Rational::Big(m_Num, m_Den));
+}
+
+void RationalAccumulator::defer()
+{
+    parts(m_Small, m_Num, m_Den);
+    m_Deferred = true;
+    m_Limit = initialLimit;
+}
+
+void RationalAccumulator::addParts(const Int &num, const Int &den)
+{
+    if (den == m_Den)
+    {
+        m_Num += num;
+        return;
+    }
+    m_Num = m_Num * den + num * m_Den;
+    m_Den *= den;
+    reduceIfLarge();
+}
+
+void RationalAccumulator::multiplyParts(const Int &num, const Int &den)
+{
+    m_Num *= num;
+    m_Den *= den;
+    reduceIfLarge();
+}
+
+void RationalAccumulator::reduceIfLarge()
+{
+    if (m_Den == 1 || std::max(bitLength(m_Num), bitLength(m_Den)) <= m_Limit)
+    {
+        return;
+    }
+    Int g = boost::multiprecision::gcd(m_Num, m_Den);
+    if (g != 1)
+    {
+        m_Num /= g;
+        m_Den /= g;
+    }
+    m_Limit = std::max(initialLimit, 2 * std::max(bitLength(m_Num), bitLength(m_Den)));
+}
@@ -0,0 +1,74 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           RationalAccumulator.h
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Sums and products of many rationals with deferred reduction
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#pragma once
+#ifndef _RATIONAL_ACCUMULATOR_H_
+#define _RATIONAL_ACCUMULATOR_H_
+
+#include <cstddef>
+#include "Rational.h"
+
+// Sum or product of a chain of rationals. Every cpp_rational operation
+// divides its result by a gcd, which dominates long chains once the
+// operands grow. The accumulator stays on the inline Rational arithmetic
+// while the values fit, then keeps an unreduced numerator and denominator
+// and only reduces when they grow past a limit. After each reduction the
+// limit becomes twice the reduced size, at least 2048 bits, so the gcd
+// runs once per doubling. result() reduces once more.
+class RationalAccumulator
+{
+public:
+    explicit RationalAccumulator(Rational initial) : m_Small(std::move(initial)) {}
+
+    void add(const Rational &value);
+    void subtract(const Rational &value);
+    void multiply(const Rational &value);
+    // Throws on division by zero
+    void divide(const Rational &value);
+
+    Rational result() const;
+
+private:
+    using Int = boost::multiprecision::cpp_int;
+
+    // Leaves the inline arithmetic with the current value
+    void defer();
+    void addParts(const Int &num, const Int &den);
+    void multiplyParts(const Int &num, const Int &den);
+    void reduceIfLarge();
+
+    Rational m_Small;
+    bool m_Deferred = false;
+    Int m_Num;
+    Int m_Den;
+    size_t m_Limit = 0;
+};
+
+#endif
@@ -31,6 +31,7 @@
 #include "app.h"
 #include "ImGuiCalculatorInput.h"
 #include "Expression.h"
+#include "Metrics.h"
 #include <functional>
 #include <chrono>
 #include <thread>
@@ -49,16 +50,52 @@ int App::init(const char *windowTitle)
     // ImGuiIO& io = ImGui::GetIO();
     // io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
     ImGuiCalculatorInput::init();
+    Metrics::setEnabled(true);
+    preview.setResultCallback([]() { Renderer::wake(); });
+    evaluator.setResultCallback([]() { Renderer::wake(); });
     running = true;
     return 0;
 }
 
 int App::run()
 {
+    int framesToRender = settle_frames;
     while (running && renderer.isRunning())
     {
+        // Nothing changes on screen without input, so an idle calculator
+        // blocks here instead of redrawing the same frame
+        if (framesToRender > 0 || animating)
+        {
+            if (renderer.processEvents())
+            {
+                framesToRender = settle_frames;
+            }
+        }
+        else
+        {
+            auto waitStart = std::chrono::steady_clock::now();
+            int events = renderer.waitEvents(showDiagnostics ? diagnostics_refresh_ms : -1);
+            Metrics::record(Metric::IDLE_US, std::chrono::duration_cast<std::chrono::microseconds>(
+                                                 std::chrono::steady_clock::now() - waitStart).count());
+            if (events)
+            {
+                framesToRender = settle_frames;
+            }
+            else if (!showDiagnostics)
+            {
+                continue;
+            }
+        }
+        if (!running || !renderer.isRunning())
+        {
+            break;
+        }
+        if (framesToRender > 0)
+        {
+            framesToRender--;
+        }
+
         auto start = std::chrono::high_resolution_clock::now();
-        renderer.processEvents();
         renderer.beginFrame();
         render();
         renderer.endFrame();
@@ -68,28 +105,56 @@ int App::run()
     
             if (input.enterPressed)
             {
-                Expression exp(input.text);
-                std::string val;
-                try
-                {
-                    std::ostringstream oss;
-                    oss << exp.eval();
-                    val = oss.str();
-                }
-                catch (const std::exception& e)
+                evaluator.submit(input.text);
+                input.enterPressed = false;
+                input.pending = true;
+            }
+            if (input.cancelRequested)
+            {
+                evaluator.cancel();
+                input.cancelRequested = false;
+            }
+
+            AsyncEvaluator::Result result;
+            if (evaluator.poll(result))
+            {
+                switch (result.status)
                 {
-                    val = std::string("Error: ") + e.what();
+                case AsyncEvaluator::Status::OK:
+                    input.text = result.text;
+                    input.processed = true;
+                    break;
+                case AsyncEvaluator::Status::ERROR:
+                    input.text = "Error: " + result.text;
                     input.error = true;
+                    input.processed = true;
+                    break;
+                case AsyncEvaluator::Status::CANCELLED:
+                    // Keep the expression, so it can be edited
+                    input.lastExpr.clear();
+                    break;
                 }
-                input.text = val;
-                input.enterPressed = false;
-                input.processed = true;
+                input.pending = false;
+                preview.setVariables(evaluator.variables());
+                framesToRender = settle_frames;
             }
+            input.pendingSeconds = input.pending ? std::chrono::duration<float>(evaluator.elapsed()).count() : 0.0f;
+            if (input.pending)
+            {
+                // The spinner turns without any input
+                animating = true;
+            }
+
+            // A shown result or error is not an expression being typed
+            preview.submit(input.processed || input.error || input.pending ? std::string() : input.text);
+            input.preview = preview.result();
         }
 
         auto end = std::chrono::high_resolution_clock::now();
+        Metrics::record(Metric::FRAME_US, std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+        // SDL_RenderPresent() already waits for the display with VSYNC
         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        if (elapsed < frame_time_ms) {
+        if (!renderer.hasVsync() && elapsed < frame_time_ms) {
             std::this_thread::sleep_for(std::chrono::milliseconds(frame_time_ms - elapsed));
         }
     }
@@ -125,4 +190,79 @@ void App::render()
         ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoScrollbar);
 
     ImGui::PopStyleVar(1);
+
+    if (ImGui::IsKeyPressed(ImGuiKey_F12))
+    {
+        showDiagnostics = !showDiagnostics;
+    }
+    if (showDiagnostics)
+    {
+        renderDiagnostics();
+    }
+
+    // A held button or key repeat keeps changing the frame without new events
+    animating = ImGui::IsAnyItemActive() || ImGui::IsAnyMouseDown();
+}
+
+void App::renderDiagnostics()
+{
+    if (!ImGui::Begin("Diagnostics", &showDiagnostics, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::BeginTable("metrics", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        const char *headers[] = {"metric", "count", "mean", "p50", "p99", "max"};
+        for (const char *header : headers)
+        {
+            ImGui::TableSetupColumn(header);
+        }
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < static_cast<size_t>(Metric::COUNT); ++i)
+        {
+            Metric metric = static_cast<Metric>(i);
+            HistogramSnapshot snapshot = Metrics::histogram(metric).snapshot();
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextUnformatted(Metrics::name(metric));
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%llu", (unsigned long long)snapshot.count);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.0f", snapshot.mean());
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%llu", (unsigned long long)snapshot.percentile(0.5));
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%llu", (unsigned long long)snapshot.percentile(0.99));
+            ImGui::TableSetColumnIndex(5);
+            ImGui::Text("%llu", (unsigned long long)snapshot.max);
+        }
+        ImGui::EndTable();
+    }
+
+    CacheStats asts = evaluator.astStats();
+    CacheStats results = evaluator.resultStats();
+    ImGui::Text("AST cache: %llu hits, %llu misses, %llu evictions, %zu bytes", (unsigned long long)asts.hits,
+                (unsigned long long)asts.misses, (unsigned long long)asts.evictions, asts.memoryUsage);
+    ImGui::Text("Result cache: %llu hits, %llu misses, %llu evictions, %zu bytes", (unsigned long long)results.hits,
+                (unsigned long long)results.misses, (unsigned long long)results.evictions, results.memoryUsage);
+
+    if (ImGui::Button("Dump JSON"))
+    {
+        const char *path = "calculator-metrics.json";
+        diagnosticsStatus = Metrics::writeJson(path) ? std::string("Written to ") + path
+                                                     : std::string("Cannot write ") + path;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+    {
+        Metrics::reset();
+        diagnosticsStatus.clear();
+    }
+    if (!diagnosticsStatus.empty())
+    {
+        ImGui::TextUnformatted(diagnosticsStatus.c_str());
+    }
+    ImGui::End();
 }
@@ -33,6 +33,8 @@
 #define _APP_H_
 
 #include "render.h"
+#include "AsyncEvaluator.h"
+#include "PreviewEvaluator.h"
 
 class App
 {
@@ -52,9 +54,17 @@ public:
 private:
     void processEvents(SDL_Event &event);
     void render();
+    void renderDiagnostics();
 private:
     bool running = false;
+    bool showDiagnostics = false; // toggled with F12
+    std::string diagnosticsStatus;
     Renderer renderer;
-    const int frame_time_ms = 1000 / 60;
+    AsyncEvaluator evaluator;
+    PreviewEvaluator preview;
+    bool animating = false;
+    const int frame_time_ms = 1000 / 60;   // only used without VSYNC
+    const int settle_frames = 3;           // ImGui needs a few frames to apply hover and focus changes
+    const int diagnostics_refresh_ms = 250;
 };
 #endif
\ No newline at end of file
@@ -29,11 +29,18 @@
  * -----------------------------------------------------------------------------
  */
 #include "app.h"
+#include "BatchRunner.h"
+#include <cstring>
 
 App app;
 
-int main(int, char **)
+int main(int argc, char **argv)
 {
+    // Headless mode, evaluates stdin or files without bringing up SDL
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0)
+    {
+        return runBatchCli(argc - 1, argv + 1);
+    }
     if (app.init("Calculator"))
     {
         return -1;
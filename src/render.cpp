@@ -30,6 +30,8 @@
  */
 #include "render.h"
 
+std::atomic<Uint32> Renderer::wakeEventType{(Uint32)-1};
+
 int Renderer::init(const char* windowTitle)
 {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0)
@@ -41,6 +43,9 @@ int Renderer::init(const char* windowTitle)
     // Create window
     window = SDL_CreateWindow(windowTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 480, 600, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    SDL_RendererInfo info;
+    vsync = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC);
+    wakeEventType = SDL_RegisterEvents(1);
     
     SDL_GetWindowSize(window, &windowWidth, &windowHeight);
 
@@ -62,31 +67,66 @@ int Renderer::init(const char* windowTitle)
     return 0;
 }
 
-void Renderer::processEvents()
+int Renderer::processEvents()
 {
+    int count = 0;
     while (SDL_PollEvent(&event))
     {
-        ImGui_ImplSDL2_ProcessEvent(&event);
-        if (event.type == SDL_QUIT)
-        {
-            running = false;
-        }
-        if (event.type == SDL_WINDOWEVENT &&
-            (event.window.event == SDL_WINDOWEVENT_RESIZED || event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED))
-        {
-            SDL_GetWindowSize(window, &windowWidth, &windowHeight);
-            //SDL_RenderSetLogicalSize(renderer, windowWidth, windowHeight);
-        }
-        if (m_eventCallback)
-        {
-            m_eventCallback(event);
-        }
+        handleEvent();
+        count++;
+    }
+    return count;
+}
+
+int Renderer::waitEvents(int timeoutMs)
+{
+    if (!SDL_WaitEventTimeout(&event, timeoutMs))
+    {
+        return 0;
+    }
+    handleEvent();
+    return 1 + processEvents();
+}
+
+void Renderer::wake()
+{
+    Uint32 type = wakeEventType;
+    if (type == (Uint32)-1)
+    {
+        return;
+    }
+    SDL_Event wakeEvent;
+    SDL_zero(wakeEvent);
+    wakeEvent.type = type;
+    SDL_PushEvent(&wakeEvent);
+}
+
+void Renderer::handleEvent()
+{
+    if (event.type == wakeEventType)
+    {
+        // Only there to end the wait, ImGui does not know this event
+        return;
+    }
+    ImGui_ImplSDL2_ProcessEvent(&event);
+    if (event.type == SDL_QUIT)
+    {
+        running = false;
+    }
+    if (event.type == SDL_WINDOWEVENT &&
+        (event.window.event == SDL_WINDOWEVENT_RESIZED || event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED))
+    {
+        SDL_GetWindowSize(window, &windowWidth, &windowHeight);
+        //SDL_RenderSetLogicalSize(renderer, windowWidth, windowHeight);
+    }
+    if (m_eventCallback)
+    {
+        m_eventCallback(event);
     }
 }
 
 void Renderer::beginFrame()
 {
-    processEvents();
     ImGui_ImplSDLRenderer2_NewFrame();
     ImGui_ImplSDL2_NewFrame();
     ImGui::NewFrame();
@@ -110,5 +150,6 @@ void Renderer::shutdown()
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
+    wakeEventType = (Uint32)-1;
     running = false;
 }
\ No newline at end of file
@@ -36,6 +36,7 @@
  * -----------------------------------------------------------------------------
  */
 #include <SDL2/SDL.h>
+#include <atomic>
 #include <functional>
 
 class Renderer
@@ -57,7 +58,17 @@ public:
     void beginFrame();
     void endFrame();
     void shutdown();
-    void processEvents();
+    // Handles the queued events, returns the number handled
+    int processEvents();
+    // Blocks until an event arrives or timeoutMs passes (-1 waits forever),
+    // then handles it with the rest of the queue
+    int waitEvents(int timeoutMs);
+    // Wakes up waitEvents(), safe to call from any thread
+    static void wake();
+    bool hasVsync() const
+    {
+        return vsync;
+    }
     bool isRunning() const
     {
         return running;
@@ -71,7 +82,11 @@ public:
         return ImVec2(windowWidth, windowHeight);
     }
 private:
+    void handleEvent();
+private:
+    static std::atomic<Uint32> wakeEventType; // registered in init()
     bool running = false;
+    bool vsync = false;
     int windowHeight, windowWidth;
     SDL_Event event;
     SDL_Window *window;
@@ -0,0 +1,651 @@
+/*
+ * -----------------------------------------------------------------------------
+ *  File:           font_embed.cpp
+ *  Project:        Calculator
+ *  Author:         Rbel12b (https::/github.com/rbel12b)
+ *  Description:    Build tool, subsets a TrueType font and embeds it as a header
+ * -----------------------------------------------------------------------------
+ *  License:        MIT License
+ *
+ *  Copyright (c) 2025 Rbel12b
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ * -----------------------------------------------------------------------------
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Keeps only the glyphs of the requested code point ranges and the tables
+// stb_truetype reads, then writes the font as a C array like xxd -i does.
+// Glyph ids are renumbered, hinting instructions and layout tables (kerning,
+// ligatures) are dropped since ImGui uses neither.
+
+namespace
+{
+    typedef std::vector<uint8_t> Bytes;
+
+    struct Range
+    {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    uint16_t read16(const Bytes &data, size_t offset)
+    {
+        if (offset + 2 > data.size())
+        {
+            throw std::runtime_error("truncated font");
+        }
+        return static_cast<uint16_t>(data[offset] << 8 | data[offset + 1]);
+    }
+
+    uint32_t read32(const Bytes &data, size_t offset)
+    {
+        return static_cast<uint32_t>(read16(data, offset)) << 16 | read16(data, offset + 2);
+    }
+
+    void write16(Bytes &data, size_t offset, uint16_t value)
+    {
+        data[offset] = static_cast<uint8_t>(value >> 8);
+        data[offset + 1] = static_cast<uint8_t>(value);
+    }
+
+    void append16(Bytes &data, uint16_t value)
+    {
+        data.push_back(static_cast<uint8_t>(value >> 8));
+        data.push_back(static_cast<uint8_t>(value));
+    }
+
+    void append32(Bytes &data, uint32_t value)
+    {
+        append16(data, static_cast<uint16_t>(value >> 16));
+        append16(data, static_cast<uint16_t>(value));
+    }
+
+    uint32_t checksum(const Bytes &data, size_t offset, size_t length)
+    {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < length; i += 4)
+        {
+            uint32_t word = 0;
+            for (size_t j = 0; j < 4; ++j)
+            {
+                word = word << 8 | (i + j < length ? data[offset + i + j] : 0);
+            }
+            sum += word;
+        }
+        return sum;
+    }
+
+    std::vector<Range> parseRanges(const std::string &text)
+    {
+        // "0x20-0xFF,0x2200-0x22FF"
+        std::vector<Range> ranges;
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            size_t end = text.find(',', pos);
+            if (end == std::string::npos)
+            {
+                end = text.size();
+            }
+            std::string item = text.substr(pos, end - pos);
+            size_t dash = item.find('-');
+            char *rest = nullptr;
+            Range range;
+            range.first = static_cast<uint32_t>(std::strtoul(item.c_str(), &rest, 0));
+            range.last = dash == std::string::npos
+                             ? range.first
+                             : static_cast<uint32_t>(std::strtoul(item.c_str() + dash + 1, &rest, 0));
+            if (rest == nullptr || *rest != '\0' || range.last < range.first || range.last > 0x10FFFF)
+            {
+                throw std::runtime_error("invalid range '" + item + "'");
+            }
+            ranges.push_back(range);
+            pos = end + 1;
+        }
+        if (ranges.empty())
+        {
+            throw std::runtime_error("no ranges given");
+        }
+        return ranges;
+    }
+
+    class Font
+    {
+    public:
+        explicit Font(Bytes data) : m_Data(std::move(data))
+        {
+            uint32_t version = read32(m_Data, 0);
+            if (version != 0x00010000 && version != 0x74727565) // 'true'
+            {
+                throw std::runtime_error("not a TrueType font with glyf outlines");
+            }
+            uint16_t numTables = read16(m_Data, 4);
+            for (uint16_t i = 0; i < numTables; ++i)
+            {
+                size_t record = 12 + i * 16;
+                std::string tag(reinterpret_cast<const char *>(&m_Data[record]), 4);
+                uint32_t offset = read32(m_Data, record + 8);
+                uint32_t length = read32(m_Data, record + 12);
+                if (static_cast<uint64_t>(offset) + length > m_Data.size())
+                {
+                    throw std::runtime_error("table " + tag + " is out of bounds");
+                }
+                m_Tables[tag] = {offset, length};
+            }
+            for (const char *tag : {"cmap", "glyf", "head", "hhea", "hmtx", "loca", "maxp"})
+            {
+                table(tag);
+            }
+            m_NumGlyphs = read16(m_Data, table("maxp").offset + 4);
+            m_NumHMetrics = read16(m_Data, table("hhea").offset + 34);
+            m_LongLoca = read16(m_Data, table("head").offset + 50) != 0;
+            if (m_NumHMetrics == 0 || m_NumHMetrics > m_NumGlyphs)
+            {
+                throw std::runtime_error("invalid hhea.numberOfHMetrics");
+            }
+            findCmap();
+        }
+
+        struct Table
+        {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        bool has(const std::string &tag) const
+        {
+            return m_Tables.count(tag) != 0;
+        }
+
+        const Table &table(const std::string &tag) const
+        {
+            auto it = m_Tables.find(tag);
+            if (it == m_Tables.end())
+            {
+                throw std::runtime_error("missing " + tag + " table");
+            }
+            return it->second;
+        }
+
+        Bytes tableData(const std::string &tag) const
+        {
+            const Table &t = table(tag);
+            return Bytes(m_Data.begin() + t.offset, m_Data.begin() + t.offset + t.length);
+        }
+
+        uint16_t numGlyphs() const
+        {
+            return m_NumGlyphs;
+        }
+
+        // 0 (.notdef) for unmapped code points
+        uint16_t glyphFor(uint32_t codepoint) const
+        {
+            size_t sub = m_Cmap;
+            if (read16(m_Data, sub) == 12)
+            {
+                uint32_t groups = read32(m_Data, sub + 12);
+                for (uint32_t i = 0; i < groups; ++i)
+                {
+                    size_t group = sub + 16 + i * 12;
+                    uint32_t first = read32(m_Data, group);
+                    uint32_t last = read32(m_Data, group + 4);
+                    if (codepoint >= first && codepoint <= last)
+                    {
+                        return static_cast<uint16_t>(read32(m_Data, group + 8) + (codepoint - first));
+                    }
+                }
+                return 0;
+            }
+
+            // Format 4
+            if (codepoint > 0xFFFF)
+            {
+                return 0;
+            }
+            uint16_t segments = read16(m_Data, sub + 6) / 2;
+            size_t endCodes = sub + 14;
+            size_t startCodes = endCodes + segments * 2 + 2;
+            size_t deltas = startCodes + segments * 2;
+            size_t rangeOffsets = deltas + segments * 2;
+            for (uint16_t i = 0; i < segments; ++i)
+            {
+                if (codepoint > read16(m_Data, endCodes + i * 2))
+                {
+                    continue;
+                }
+                uint16_t start = read16(m_Data, startCodes + i * 2);
+                if (codepoint < start)
+                {
+                    return 0;
+                }
+                uint16_t delta = read16(m_Data, deltas + i * 2);
+                uint16_t rangeOffset = read16(m_Data, rangeOffsets + i * 2);
+                if (rangeOffset == 0)
+                {
+                    return static_cast<uint16_t>(codepoint + delta);
+                }
+                uint16_t glyph = read16(m_Data, rangeOffsets + i * 2 + rangeOffset + (codepoint - start) * 2);
+                return glyph == 0 ? 0 : static_cast<uint16_t>(glyph + delta);
+            }
+            return 0;
+        }
+
+        // Outline bytes of a glyph, empty for glyphs without contours
+        Bytes glyph(uint16_t id) const
+        {
+            if (id >= m_NumGlyphs)
+            {
+                throw std::runtime_error("glyph id out of range");
+            }
+            size_t loca = table("loca").offset;
+            uint32_t begin, end;
+            if (m_LongLoca)
+            {
+                begin = read32(m_Data, loca + id * 4);
+                end = read32(m_Data, loca + id * 4 + 4);
+            }
+            else
+            {
+                begin = read16(m_Data, loca + id * 2) * 2u;
+                end = read16(m_Data, loca + id * 2 + 2) * 2u;
+            }
+            const Table &glyf = table("glyf");
+            if (begin > end || end > glyf.length)
+            {
+                throw std::runtime_error("invalid loca entry");
+            }
+            return Bytes(m_Data.begin() + glyf.offset + begin, m_Data.begin() + glyf.offset + end);
+        }
+
+        void metrics(uint16_t id, uint16_t &advance, uint16_t &lsb) const
+        {
+            size_t hmtx = table("hmtx").offset;
+            if (id < m_NumHMetrics)
+            {
+                advance = read16(m_Data, hmtx + id * 4);
+                lsb = read16(m_Data, hmtx + id * 4 + 2);
+            }
+            else
+            {
+                // Monospaced tail: the last advance repeats, only the bearing is stored
+                advance = read16(m_Data, hmtx + (m_NumHMetrics - 1) * 4);
+                lsb = read16(m_Data, hmtx + m_NumHMetrics * 4 + (id - m_NumHMetrics) * 2);
+            }
+        }
+
+    private:
+        void findCmap()
+        {
+            // Prefer the full Unicode subtable, then the BMP one
+            const Table &cmap = table("cmap");
+            uint16_t count = read16(m_Data, cmap.offset + 2);
+            int best = -1;
+            for (uint16_t i = 0; i < count; ++i)
+            {
+                size_t record = cmap.offset + 4 + i * 8;
+                uint16_t platform = read16(m_Data, record);
+                uint16_t encoding = read16(m_Data, record + 2);
+                size_t sub = cmap.offset + read32(m_Data, record + 4);
+                uint16_t format = read16(m_Data, sub);
+                int score = 0;
+                if (format == 12 && (platform == 0 || (platform == 3 && encoding == 10)))
+                {
+                    score = 2;
+                }
+                else if (format == 4 && (platform == 0 || (platform == 3 && encoding == 1)))
+                {
+                    score = 1;
+                }
+                if (score > best)
+                {
+                    best = score;
+                    m_Cmap = sub;
+                }
+            }
+            if (best < 1)
+            {
+                throw std::runtime_error("no Unicode cmap subtable of format 4 or 12");
+            }
+        }
+
+        Bytes m_Data;
+        std::map<std::string, Table> m_Tables;
+        uint16_t m_NumGlyphs = 0;
+        uint16_t m_NumHMetrics = 0;
+        bool m_LongLoca = false;
+        size_t m_Cmap = 0;
+    };
+
+    // Composite glyph flags
+    const uint16_t ARG_1_AND_2_ARE_WORDS = 0x0001;
+    const uint16_t WE_HAVE_A_SCALE = 0x0008;
+    const uint16_t MORE_COMPONENTS = 0x0020;
+    const uint16_t WE_HAVE_AN_X_AND_Y_SCALE = 0x0040;
+    const uint16_t WE_HAVE_A_TWO_BY_TWO = 0x0080;
+    const uint16_t WE_HAVE_INSTRUCTIONS = 0x0100;
+
+    // Calls visit(offset of the glyph index) for every component, returns
+    // the end of the component records
+    template <typename Visit>
+    size_t forEachComponent(const Bytes &glyph, Visit visit)
+    {
+        size_t pos = 10;
+        uint16_t flags;
+        do
+        {
+            flags = read16(glyph, pos);
+            visit(pos + 2, flags);
+            pos += 4 + ((flags & ARG_1_AND_2_ARE_WORDS) ? 4 : 2);
+            if (flags & WE_HAVE_A_SCALE)
+            {
+                pos += 2;
+            }
+            else if (flags & WE_HAVE_AN_X_AND_Y_SCALE)
+            {
+                pos += 4;
+            }
+            else if (flags & WE_HAVE_A_TWO_BY_TWO)
+            {
+                pos += 8;
+            }
+        } while (flags & MORE_COMPONENTS);
+        return pos;
+    }
+
+    bool isComposite(const Bytes &glyph)
+    {
+        return glyph.size() >= 10 && static_cast<int16_t>(read16(glyph, 0)) < 0;
+    }
+
+    // Copy of the glyph without hinting instructions and with its component
+    // ids renumbered
+    Bytes rewriteGlyph(const Bytes &glyph, const std::map<uint16_t, uint16_t> &ids)
+    {
+        if (glyph.empty())
+        {
+            return glyph;
+        }
+        if (isComposite(glyph))
+        {
+            Bytes out = glyph;
+            size_t lastFlags = 0;
+            size_t end = forEachComponent(glyph, [&](size_t index, uint16_t) {
+                write16(out, index, ids.at(read16(glyph, index)));
+                lastFlags = index - 2;
+            });
+            write16(out, lastFlags, read16(out, lastFlags) & ~WE_HAVE_INSTRUCTIONS);
+            out.resize(end);
+            return out;
+        }
+
+        uint16_t contours = read16(glyph, 0);
+        size_t lengthOffset = 10 + contours * 2;
+        size_t instructions = read16(glyph, lengthOffset);
+        Bytes out(glyph.begin(), glyph.begin() + lengthOffset);
+        append16(out, 0);
+        size_t rest = lengthOffset + 2 + instructions;
+        if (rest > glyph.size())
+        {
+            throw std::runtime_error("truncated glyph");
+        }
+        out.insert(out.end(), glyph.begin() + rest, glyph.end());
+        return out;
+    }
+
+    Bytes subset(const Font &font, const std::vector<Range> &ranges)
+    {
+        // Glyphs to keep, old id -> new id. .notdef has to stay glyph 0.
+        std::map<uint32_t, uint16_t> codepoints;
+        std::set<uint16_t> keep = {0};
+        for (const Range &range : ranges)
+        {
+            for (uint32_t c = range.first; c <= range.last; ++c)
+            {
+                uint16_t id = font.glyphFor(c);
+                if (id != 0)
+                {
+                    codepoints[c] = id;
+                    keep.insert(id);
+                }
+            }
+        }
+        std::vector<uint16_t> pending(keep.begin(), keep.end());
+        while (!pending.empty())
+        {
+            Bytes glyph = font.glyph(pending.back());
+            pending.pop_back();
+            if (isComposite(glyph))
+            {
+                forEachComponent(glyph, [&](size_t index, uint16_t) {
+                    uint16_t component = read16(glyph, index);
+                    if (keep.insert(component).second)
+                    {
+                        pending.push_back(component);
+                    }
+                });
+            }
+        }
+        std::map<uint16_t, uint16_t> ids;
+        for (uint16_t id : keep)
+        {
+            uint16_t next = static_cast<uint16_t>(ids.size());
+            ids[id] = next;
+        }
+        uint16_t count = static_cast<uint16_t>(ids.size());
+
+        std::map<std::string, Bytes> tables;
+
+        Bytes &glyf = tables["glyf"];
+        Bytes &loca = tables["loca"];
+        Bytes &hmtx = tables["hmtx"];
+        for (auto &id : ids)
+        {
+            append32(loca, static_cast<uint32_t>(glyf.size()));
+            Bytes glyph = rewriteGlyph(font.glyph(id.first), ids);
+            glyf.insert(glyf.end(), glyph.begin(), glyph.end());
+            glyf.resize((glyf.size() + 3) & ~size_t(3));
+            uint16_t advance, lsb;
+            font.metrics(id.first, advance, lsb);
+            append16(hmtx, advance);
+            append16(hmtx, lsb);
+        }
+        append32(loca, static_cast<uint32_t>(glyf.size()));
+
+        // Format 12 subtable, one group per run of consecutive glyph ids
+        Bytes groups;
+        uint32_t groupCount = 0;
+        for (auto it = codepoints.begin(); it != codepoints.end();)
+        {
+            uint32_t first = it->first;
+            uint16_t glyph = ids.at(it->second);
+            uint32_t last = first;
+            for (++it; it != codepoints.end() && it->first == last + 1 && ids.at(it->second) == glyph + (last + 1 - first);
+                 ++it)
+            {
+                last++;
+            }
+            append32(groups, first);
+            append32(groups, last);
+            append32(groups, glyph);
+            groupCount++;
+        }
+        Bytes &cmap = tables["cmap"];
+        append16(cmap, 0); // version
+        append16(cmap, 1); // subtables
+        append16(cmap, 3); // Windows
+        append16(cmap, 10); // Unicode full repertoire
+        append32(cmap, 12);
+        append16(cmap, 12); // format
+        append16(cmap, 0);
+        append32(cmap, 16 + static_cast<uint32_t>(groups.size()));
+        append32(cmap, 0); // language
+        append32(cmap, groupCount);
+        cmap.insert(cmap.end(), groups.begin(), groups.end());
+
+        Bytes &head = tables["head"] = font.tableData("head");
+        write16(head, 8, 0); // checkSumAdjustment, set when writing the file
+        write16(head, 10, 0);
+        write16(head, 50, 1); // long loca offsets
+
+        Bytes &hhea = tables["hhea"] = font.tableData("hhea");
+        write16(hhea, 34, count);
+
+        Bytes &maxp = tables["maxp"] = font.tableData("maxp");
+        write16(maxp, 4, count);
+        if (maxp.size() >= 32)
+        {
+            write16(maxp, 26, 0); // maxSizeOfInstructions
+        }
+
+        // Version 3 has no glyph names, which would refer to the old ids
+        if (font.has("post"))
+        {
+            Bytes &post = tables["post"] = font.tableData("post");
+            post.resize(32);
+            write16(post, 0, 3);
+            write16(post, 2, 0);
+        }
+        // The copyright and license notices live in name
+        for (const char *tag : {"name", "OS/2"})
+        {
+            if (font.has(tag))
+            {
+                tables[tag] = font.tableData(tag);
+            }
+        }
+
+        // Table directory, tables sorted by tag as required
+        uint16_t numTables = static_cast<uint16_t>(tables.size());
+        uint16_t entrySelector = 0;
+        while ((2u << entrySelector) <= numTables)
+        {
+            entrySelector++;
+        }
+        uint16_t searchRange = static_cast<uint16_t>(16u << entrySelector);
+        Bytes out;
+        append32(out, 0x00010000);
+        append16(out, numTables);
+        append16(out, searchRange);
+        append16(out, entrySelector);
+        append16(out, static_cast<uint16_t>(numTables * 16 - searchRange));
+        size_t offset = 12 + numTables * 16;
+        size_t headOffset = 0;
+        for (auto &t : tables)
+        {
+            out.insert(out.end(), t.first.begin(), t.first.end());
+            append32(out, checksum(t.second, 0, t.second.size()));
+            append32(out, static_cast<uint32_t>(offset));
+            append32(out, static_cast<uint32_t>(t.second.size()));
+            if (t.first == "head")
+            {
+                headOffset = offset;
+            }
+            offset += (t.second.size() + 3) & ~size_t(3);
+        }
+        for (auto &t : tables)
+        {
+            out.insert(out.end(), t.second.begin(), t.second.end());
+            out.resize((out.size() + 3) & ~size_t(3));
+        }
+        uint32_t adjustment = 0xB1B0AFBA - checksum(out, 0, out.size());
+        write16(out, headOffset + 8, static_cast<uint16_t>(adjustment >> 16));
+        write16(out, headOffset + 10, static_cast<uint16_t>(adjustment));
+        return out;
+    }
+
+    void writeHeader(const std::string &path, const std::string &symbol, const std::string &source,
+                     const std::vector<Range> &ranges, const Bytes &font)
+    {
+        std::string text;
+        text.reserve(font.size() * 6 + 1024);
+        text += "// Generated by font_embed from " + source + ", do not edit\n";
+        text += "#define " + symbol + "_ranges";
+        char buf[32];
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            std::snprintf(buf, sizeof(buf), "%s 0x%04X, 0x%04X", i ? "," : "", ranges[i].first, ranges[i].last);
+            text += buf;
+        }
+        text += "\nunsigned char " + symbol + "[] = {";
+        for (size_t i = 0; i < font.size(); ++i)
+        {
+            std::snprintf(buf, sizeof(buf), "%s0x%02x", i % 12 ? ", " : (i ? ",\n  " : "\n  "), font[i]);
+            text += buf;
+        }
+        text += "\n};\nunsigned int " + symbol + "_len = " + std::to_string(font.size()) + ";\n";
+
+        std::ofstream out(path, std::ios::binary);
+        out << text;
+        if (!out)
+        {
+            throw std::runtime_error("cannot write " + path);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 5)
+    {
+        std::fprintf(stderr,
+                     "usage: %s font.ttf output.h symbol ranges\n"
+                     "Writes the glyphs of the code point ranges (e.g. 0x20-0xFF,0x2200-0x22FF)\n"
+                     "as the array <symbol> and its length <symbol>_len.\n",
+                     argv[0]);
+        return 2;
+    }
+    try
+    {
+        std::ifstream in(argv[1], std::ios::binary);
+        if (!in)
+        {
+            throw std::runtime_error(std::string("cannot read ") + argv[1]);
+        }
+        Bytes data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::vector<Range> ranges = parseRanges(argv[4]);
+        Bytes font = subset(Font(std::move(data)), ranges);
+
+        std::string source = argv[1];
+        size_t slash = source.find_last_of("/\\");
+        if (slash != std::string::npos)
+        {
+            source = source.substr(slash + 1);
+        }
+        writeHeader(argv[2], argv[3], source, ranges, font);
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        return 1;
+    }
+    return 0;
+}